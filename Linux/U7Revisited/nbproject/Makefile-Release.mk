@@ -48,19 +48,37 @@ OBJECTFILES= \
 	${OBJECTDIR}/_ext/d8db8d98/RNG.o \
 	${OBJECTDIR}/_ext/d8db8d98/ResourceManager.o \
 	${OBJECTDIR}/_ext/d8db8d98/StateMachine.o \
+	${OBJECTDIR}/_ext/d8db8d98/ThreadPool.o \
 	${OBJECTDIR}/_ext/d8db8d98/TooltipSystem.o \
+	${OBJECTDIR}/_ext/957bd1db/AssetCache.o \
+	${OBJECTDIR}/_ext/957bd1db/Benchmarks.o \
+	${OBJECTDIR}/_ext/957bd1db/CameraFrustum.o \
+	${OBJECTDIR}/_ext/957bd1db/ChunkObjectMap.o \
+	${OBJECTDIR}/_ext/957bd1db/ChunkTemplates.o \
+	${OBJECTDIR}/_ext/957bd1db/DepthSort.o \
+	${OBJECTDIR}/_ext/957bd1db/FlxArchive.o \
 	${OBJECTDIR}/_ext/957bd1db/LoadingState.o \
 	${OBJECTDIR}/_ext/957bd1db/Main.o \
 	${OBJECTDIR}/_ext/957bd1db/MainState.o \
+	${OBJECTDIR}/_ext/957bd1db/MemoryStats.o \
 	${OBJECTDIR}/_ext/957bd1db/ObjectEditorState.o \
+	${OBJECTDIR}/_ext/957bd1db/ObjectPicker.o \
+	${OBJECTDIR}/_ext/957bd1db/ObjectPool.o \
+	${OBJECTDIR}/_ext/957bd1db/ObjectStore.o \
 	${OBJECTDIR}/_ext/957bd1db/OptionsState.o \
+	${OBJECTDIR}/_ext/957bd1db/ShapeAtlas.o \
 	${OBJECTDIR}/_ext/957bd1db/ShapeData.o \
+	${OBJECTDIR}/_ext/957bd1db/ShapeDecoder.o \
 	${OBJECTDIR}/_ext/957bd1db/ShapeEditorState.o \
+	${OBJECTDIR}/_ext/957bd1db/ShapeTableFile.o \
+	${OBJECTDIR}/_ext/957bd1db/SuperchunkStreamer.o \
 	${OBJECTDIR}/_ext/957bd1db/Terrain.o \
 	${OBJECTDIR}/_ext/957bd1db/TitleState.o \
 	${OBJECTDIR}/_ext/957bd1db/U7Globals.o \
 	${OBJECTDIR}/_ext/957bd1db/U7Object.o \
-	${OBJECTDIR}/_ext/957bd1db/WorldEditorState.o
+	${OBJECTDIR}/_ext/957bd1db/VisibleObjectSet.o \
+	${OBJECTDIR}/_ext/957bd1db/WorldEditorState.o \
+	${OBJECTDIR}/_ext/957bd1db/WorldTiles.o
 
 
 # C Compiler Flags
@@ -154,11 +172,51 @@ ${OBJECTDIR}/_ext/d8db8d98/StateMachine.o: ../../Source/Geist/StateMachine.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/d8db8d98/StateMachine.o ../../Source/Geist/StateMachine.cpp
 
+${OBJECTDIR}/_ext/d8db8d98/ThreadPool.o: ../../Source/Geist/ThreadPool.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/d8db8d98
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/d8db8d98/ThreadPool.o ../../Source/Geist/ThreadPool.cpp
+
 ${OBJECTDIR}/_ext/d8db8d98/TooltipSystem.o: ../../Source/Geist/TooltipSystem.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/d8db8d98
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/d8db8d98/TooltipSystem.o ../../Source/Geist/TooltipSystem.cpp
 
+${OBJECTDIR}/_ext/957bd1db/AssetCache.o: ../../Source/AssetCache.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/AssetCache.o ../../Source/AssetCache.cpp
+
+${OBJECTDIR}/_ext/957bd1db/Benchmarks.o: ../../Source/Benchmarks.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/Benchmarks.o ../../Source/Benchmarks.cpp
+
+${OBJECTDIR}/_ext/957bd1db/CameraFrustum.o: ../../Source/CameraFrustum.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/CameraFrustum.o ../../Source/CameraFrustum.cpp
+
+${OBJECTDIR}/_ext/957bd1db/ChunkObjectMap.o: ../../Source/ChunkObjectMap.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ChunkObjectMap.o ../../Source/ChunkObjectMap.cpp
+
+${OBJECTDIR}/_ext/957bd1db/ChunkTemplates.o: ../../Source/ChunkTemplates.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ChunkTemplates.o ../../Source/ChunkTemplates.cpp
+
+${OBJECTDIR}/_ext/957bd1db/DepthSort.o: ../../Source/DepthSort.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/DepthSort.o ../../Source/DepthSort.cpp
+
+${OBJECTDIR}/_ext/957bd1db/FlxArchive.o: ../../Source/FlxArchive.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/FlxArchive.o ../../Source/FlxArchive.cpp
+
 ${OBJECTDIR}/_ext/957bd1db/LoadingState.o: ../../Source/LoadingState.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
 	${RM} "$@.d"
@@ -174,26 +232,66 @@ ${OBJECTDIR}/_ext/957bd1db/MainState.o: ../../Source/MainState.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/MainState.o ../../Source/MainState.cpp
 
+${OBJECTDIR}/_ext/957bd1db/MemoryStats.o: ../../Source/MemoryStats.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/MemoryStats.o ../../Source/MemoryStats.cpp
+
 ${OBJECTDIR}/_ext/957bd1db/ObjectEditorState.o: ../../Source/ObjectEditorState.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ObjectEditorState.o ../../Source/ObjectEditorState.cpp
 
+${OBJECTDIR}/_ext/957bd1db/ObjectPicker.o: ../../Source/ObjectPicker.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ObjectPicker.o ../../Source/ObjectPicker.cpp
+
+${OBJECTDIR}/_ext/957bd1db/ObjectPool.o: ../../Source/ObjectPool.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ObjectPool.o ../../Source/ObjectPool.cpp
+
+${OBJECTDIR}/_ext/957bd1db/ObjectStore.o: ../../Source/ObjectStore.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ObjectStore.o ../../Source/ObjectStore.cpp
+
 ${OBJECTDIR}/_ext/957bd1db/OptionsState.o: ../../Source/OptionsState.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/OptionsState.o ../../Source/OptionsState.cpp
 
+${OBJECTDIR}/_ext/957bd1db/ShapeAtlas.o: ../../Source/ShapeAtlas.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ShapeAtlas.o ../../Source/ShapeAtlas.cpp
+
 ${OBJECTDIR}/_ext/957bd1db/ShapeData.o: ../../Source/ShapeData.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ShapeData.o ../../Source/ShapeData.cpp
 
+${OBJECTDIR}/_ext/957bd1db/ShapeDecoder.o: ../../Source/ShapeDecoder.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ShapeDecoder.o ../../Source/ShapeDecoder.cpp
+
 ${OBJECTDIR}/_ext/957bd1db/ShapeEditorState.o: ../../Source/ShapeEditorState.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ShapeEditorState.o ../../Source/ShapeEditorState.cpp
 
+${OBJECTDIR}/_ext/957bd1db/ShapeTableFile.o: ../../Source/ShapeTableFile.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/ShapeTableFile.o ../../Source/ShapeTableFile.cpp
+
+${OBJECTDIR}/_ext/957bd1db/SuperchunkStreamer.o: ../../Source/SuperchunkStreamer.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/SuperchunkStreamer.o ../../Source/SuperchunkStreamer.cpp
+
 ${OBJECTDIR}/_ext/957bd1db/Terrain.o: ../../Source/Terrain.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
 	${RM} "$@.d"
@@ -214,11 +312,21 @@ ${OBJECTDIR}/_ext/957bd1db/U7Object.o: ../../Source/U7Object.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/U7Object.o ../../Source/U7Object.cpp
 
+${OBJECTDIR}/_ext/957bd1db/VisibleObjectSet.o: ../../Source/VisibleObjectSet.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/VisibleObjectSet.o ../../Source/VisibleObjectSet.cpp
+
 ${OBJECTDIR}/_ext/957bd1db/WorldEditorState.o: ../../Source/WorldEditorState.cpp
 	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
 	${RM} "$@.d"
 	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/WorldEditorState.o ../../Source/WorldEditorState.cpp
 
+${OBJECTDIR}/_ext/957bd1db/WorldTiles.o: ../../Source/WorldTiles.cpp
+	${MKDIR} -p ${OBJECTDIR}/_ext/957bd1db
+	${RM} "$@.d"
+	$(COMPILE.cc) -O2 -I../../Source/Geist -Iraylib/include -I../../ThirdParty/raylib/external -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/957bd1db/WorldTiles.o ../../Source/WorldTiles.cpp
+
 # Subprojects
 .build-subprojects:
 
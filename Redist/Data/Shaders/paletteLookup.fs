@@ -0,0 +1,22 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Input uniform values
+uniform sampler2D texture0;     // Palette indices, in the red channel
+uniform sampler2D texture1;     // 256 wide, one row per palette
+uniform int paletteIndex;
+uniform vec4 colDiffuse;
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    int index = int(texture(texture0, fragTexCoord).r * 255.0 + 0.5);
+    vec4 texelColor = texelFetch(texture1, ivec2(index, paletteIndex), 0);
+    if (texelColor.a < 0.5) discard;
+    finalColor = texelColor * fragColor * colDiffuse;
+}
@@ -0,0 +1,15 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec3 fragTexCoord;
+
+// Input uniform values
+uniform sampler2DArray chunkTextures;   // One 128x128 layer per chunk type
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    finalColor = texture(chunkTextures, fragTexCoord);
+}
@@ -0,0 +1,20 @@
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+
+// Per chunk: world x and z of its corner, and which layer of the array it uses
+in vec3 instanceChunk;
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec3 fragTexCoord;
+
+void main()
+{
+    fragTexCoord = vec3(vertexTexCoord, instanceChunk.z);
+    gl_Position = mvp * vec4(vertexPosition + vec3(instanceChunk.x, 0.0, instanceChunk.y), 1.0);
+}
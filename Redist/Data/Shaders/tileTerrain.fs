@@ -0,0 +1,33 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragWorld;
+
+// Input uniform values
+uniform usampler2D chunkMap;        // 192x192, the chunk type of each chunk
+uniform usampler2D tileTable;       // 256 wide, one row per chunk type: shape | frame << 10 for its 16x16 tiles
+uniform usampler2D frameOffsets;    // Added to the frame of every tile of a shape, for animating them
+uniform sampler2D terrainTiles;     // 8x8 per tile: shape across, frame down
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Eight texels to a tile, sixteen tiles to a chunk.
+    ivec2 texel = clamp(ivec2(floor(fragWorld * 8.0)), ivec2(0), ivec2(192 * 16 * 8 - 1));
+    ivec2 tile = texel / 8;
+    ivec2 chunk = tile / 16;
+    ivec2 tileInChunk = tile % 16;
+
+    uint chunkType = texelFetch(chunkMap, chunk, 0).r;
+    uint tileData = texelFetch(tileTable, ivec2(tileInChunk.y * 16 + tileInChunk.x, int(chunkType)), 0).r;
+    int shape = int(tileData & 0x3ffu);
+    int frame = int((tileData >> 10) & 0x1fu);
+    frame = (frame + int(texelFetch(frameOffsets, ivec2(shape, 0), 0).r)) & 31;
+
+    vec4 color = texelFetch(terrainTiles, ivec2(shape * 8 + texel.x % 8, frame * 8 + texel.y % 8), 0);
+
+    // Same as drawing the tile over black.
+    finalColor = vec4(color.rgb * color.a, 1.0);
+}
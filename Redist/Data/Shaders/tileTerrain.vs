@@ -0,0 +1,16 @@
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragWorld;
+
+void main()
+{
+    fragWorld = vertexPosition.xz;
+    gl_Position = mvp * vec4(vertexPosition, 1.0);
+}
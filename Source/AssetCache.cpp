@@ -0,0 +1,176 @@
+//  Deliberately does not include raylib.h; windows.h and raylib.h don't get along.
+
+#include "AssetCache.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+//  "U7RC", then the version, the key and the payload length.
+static const unsigned int CACHE_MAGIC = 0x43523755;
+static const unsigned int CACHE_HEADER_SIZE = 24;
+
+static void MakeDirectoryFor(const string& filename)
+{
+	size_t slash = filename.find_last_of("/\\");
+	if (slash == string::npos)
+	{
+		return;
+	}
+
+	string directory = filename.substr(0, slash);
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+}
+
+unsigned long long AssetCache::HashFiles(const vector<string>& filenames)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	auto mix = [&hash](const unsigned char* data, unsigned int length)
+	{
+		for (unsigned int i = 0; i < length; ++i)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	for (auto& filename : filenames)
+	{
+		MappedFile file;
+		if (file.Open(filename))
+		{
+			unsigned int size = file.GetSize();
+			mix((const unsigned char*)&size, sizeof(size));
+			mix(file.GetData().m_data, size);
+		}
+		else
+		{
+			//  MappedFile won't map empty files, so this covers those as well as missing ones.
+			const char missing[] = "missing";
+			mix((const unsigned char*)missing, sizeof(missing));
+		}
+	}
+
+	unsigned int version = VERSION;
+	mix((const unsigned char*)&version, sizeof(version));
+
+	return hash;
+}
+
+bool AssetCache::Open(const string& filename, unsigned long long key)
+{
+	return OpenWithKey(filename, &key);
+}
+
+bool AssetCache::Open(const string& filename)
+{
+	return OpenWithKey(filename, nullptr);
+}
+
+bool AssetCache::OpenWithKey(const string& filename, const unsigned long long* key)
+{
+	Close();
+
+	if (!m_file.Open(filename))
+	{
+		return false;
+	}
+
+	ByteReader header(m_file.GetData());
+	unsigned int magic = header.ReadU32();
+	unsigned int version = header.ReadU32();
+	unsigned long long fileKey = 0;
+	unsigned long long payloadLength = 0;
+	header.Read(&fileKey, sizeof(fileKey));
+	header.Read(&payloadLength, sizeof(payloadLength));
+
+	if (header.Failed() || magic != CACHE_MAGIC || version != VERSION || (key != nullptr && fileKey != *key) || payloadLength != header.Remaining())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+ByteSpan AssetCache::GetPayload() const
+{
+	if (!m_file.IsOpen())
+	{
+		return ByteSpan();
+	}
+
+	ByteSpan data = m_file.GetData();
+	return ByteSpan{ data.m_data + CACHE_HEADER_SIZE, data.m_length - CACHE_HEADER_SIZE };
+}
+
+AssetCacheWriter::~AssetCacheWriter()
+{
+	//  Never finished; throw the partial file away.
+	if (m_stream.is_open())
+	{
+		m_stream.close();
+		remove((m_filename + ".tmp").c_str());
+	}
+}
+
+bool AssetCacheWriter::Begin(const string& filename, unsigned long long key)
+{
+	MakeDirectoryFor(filename);
+
+	m_filename = filename;
+	m_length = 0;
+	m_stream.open(filename + ".tmp", ios::binary | ios::trunc);
+	if (!m_stream.is_open())
+	{
+		return false;
+	}
+
+	unsigned int magic = CACHE_MAGIC;
+	unsigned int version = AssetCache::VERSION;
+	unsigned long long length = 0; // Filled in by Finish().
+	m_stream.write((const char*)&magic, sizeof(magic));
+	m_stream.write((const char*)&version, sizeof(version));
+	m_stream.write((const char*)&key, sizeof(key));
+	m_stream.write((const char*)&length, sizeof(length));
+
+	return m_stream.good();
+}
+
+bool AssetCacheWriter::Finish()
+{
+	if (!m_stream.is_open())
+	{
+		return false;
+	}
+
+	m_stream.seekp(CACHE_HEADER_SIZE - sizeof(m_length));
+	m_stream.write((const char*)&m_length, sizeof(m_length));
+
+	bool good = m_stream.good();
+	m_stream.close();
+
+	string tempName = m_filename + ".tmp";
+	if (good)
+	{
+		//  rename() won't replace an existing file on Windows.
+		remove(m_filename.c_str());
+		good = rename(tempName.c_str(), m_filename.c_str()) == 0;
+	}
+
+	if (!good)
+	{
+		remove(tempName.c_str());
+	}
+
+	return good;
+}
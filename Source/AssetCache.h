@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     ASSETCACHE.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Baked copies of data that takes a while to build from the
+//           original Ultima VII files (decoded shapes, the terrain
+//           texture, the chunk textures).  Each cache file is a small
+//           header followed by a payload whose layout is up to whoever
+//           wrote it.  The header carries a key, normally a hash of the
+//           source files' contents, so a cache built from different data
+//           is simply ignored and rebuilt.
+//
+//           Cache files live in Data/cache and can be deleted at any time.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _ASSETCACHE_H_
+#define _ASSETCACHE_H_
+
+#include "FlxArchive.h"
+#include <fstream>
+
+class AssetCache
+{
+public:
+	//  Bump this whenever the layout of any cache payload changes.
+	static const unsigned int VERSION = 1;
+
+	AssetCache() {};
+
+	//  FNV-1a over the contents of the given files, in order.  A missing file
+	//  hashes differently from an empty one, so adding or removing a file
+	//  changes the key too.
+	static unsigned long long HashFiles(const std::vector<std::string>& filenames);
+
+	//  Maps the cache file and checks its header.  Returns false if it's
+	//  missing, truncated, from another version, or was built with a different key.
+	bool Open(const std::string& filename, unsigned long long key);
+
+	//  The same, but takes whatever key the file has.  For tools that convert
+	//  a cache file rather than check it's current.
+	bool Open(const std::string& filename);
+	void Close() { m_file.Close(); }
+
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	//  Everything after the header.  Only valid while the cache is open.
+	ByteSpan GetPayload() const;
+
+private:
+	bool OpenWithKey(const std::string& filename, const unsigned long long* key);
+
+	MappedFile m_file;
+};
+
+//  Writes a cache file.  The data goes to a temporary file which replaces the
+//  real one in Finish(), so a crash mid-write never leaves a bad cache behind.
+class AssetCacheWriter
+{
+public:
+	AssetCacheWriter() {};
+	~AssetCacheWriter();
+
+	bool Begin(const std::string& filename, unsigned long long key);
+
+	void Write(const void* data, unsigned int length) { m_stream.write((const char*)data, length); m_length += length; }
+	void WriteU32(unsigned int value) { Write(&value, sizeof(value)); }
+
+	//  Returns false if anything failed to write; the cache file is left untouched.
+	bool Finish();
+
+private:
+	std::ofstream m_stream;
+	std::string m_filename;
+	unsigned long long m_length = 0;
+};
+
+#endif
@@ -0,0 +1,1523 @@
+#include "Geist/Globals.h"
+#include "Geist/Logging.h"
+#include "Geist/ThreadPool.h"
+#include "Geist/Config.h"
+#include "Geist/ResourceManager.h"
+#include "U7Globals.h"
+#include "Benchmarks.h"
+#include "ShapeDecoder.h"
+#include "LoadingState.h"
+#include "MemoryStats.h"
+#include "ShapeAtlas.h"
+#include "VisibleObjectSet.h"
+#include "ObjectPicker.h"
+#include "DepthSort.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <unordered_map>
+#include <cstring>
+
+using namespace std;
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static string MBPerSecond(double bytes, double seconds)
+{
+	return to_string(bytes / (1024.0 * 1024.0) / seconds) + " MB/s";
+}
+
+int RunBenchmark(const string& name, const string& jsonFilename)
+{
+	if (name == "decode")
+	{
+		RunShapeDecodeBenchmark();
+		return 0;
+	}
+
+	if (name == "atlas")
+	{
+		return RunShapeAtlasBenchmark() ? 0 : 1;
+	}
+
+	if (name == "ireg")
+	{
+		return RunIREGBenchmark() ? 0 : 1;
+	}
+
+	if (name == "spatial")
+	{
+		return RunSpatialBenchmark() ? 0 : 1;
+	}
+
+	if (name == "picking")
+	{
+		return RunPickingBenchmark() ? 0 : 1;
+	}
+
+	if (name == "depthsort")
+	{
+		return RunDepthSortBenchmark() ? 0 : 1;
+	}
+
+	if (name == "load")
+	{
+		return RunLoadBenchmark(jsonFilename) ? 0 : 1;
+	}
+
+	return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//  Shape decoding
+////////////////////////////////////////////////////////////////////////////////
+
+static void PutU8(vector<unsigned char>& out, unsigned char value)
+{
+	out.push_back(value);
+}
+
+static void PutS16(vector<unsigned char>& out, short value)
+{
+	out.push_back((unsigned char)(value & 0xff));
+	out.push_back((unsigned char)((value >> 8) & 0xff));
+}
+
+//  Builds a frame in the SHAPES.VGA layout with a mix of raw spans and RLE spans
+//  made of raw and repeated runs, roughly like the real object art.
+static vector<unsigned char> MakeSyntheticFrame(mt19937& rng, int& width, int& height)
+{
+	uniform_int_distribution<int> sizeDist(8, 96);
+	width = sizeDist(rng);
+	height = sizeDist(rng);
+
+	vector<unsigned char> out;
+	PutS16(out, 0);                   // W2
+	PutS16(out, (short)(width - 1));  // W1
+	PutS16(out, (short)(height - 1)); // H1
+	PutS16(out, 0);                   // H2
+
+	uniform_int_distribution<int> byteDist(0, 255);
+	uniform_int_distribution<int> coinDist(0, 3);
+
+	for (int y = 0; y < height; ++y)
+	{
+		int x = uniform_int_distribution<int>(0, width / 4)(rng);
+		while (x < width)
+		{
+			int spanLength = uniform_int_distribution<int>(1, width - x)(rng);
+			bool rle = coinDist(rng) != 0;
+
+			PutS16(out, (short)((spanLength << 1) | (rle ? 1 : 0)));
+			PutS16(out, (short)(x - (width - 1)));
+			PutS16(out, (short)(y - (height - 1)));
+
+			if (!rle)
+			{
+				for (int i = 0; i < spanLength; ++i)
+				{
+					PutU8(out, (unsigned char)byteDist(rng));
+				}
+			}
+			else
+			{
+				int done = 0;
+				while (done < spanLength)
+				{
+					int runLength = uniform_int_distribution<int>(1, min(spanLength - done, 127))(rng);
+					if (coinDist(rng) == 0)
+					{
+						PutU8(out, (unsigned char)(runLength << 1));
+						for (int i = 0; i < runLength; ++i)
+						{
+							PutU8(out, (unsigned char)byteDist(rng));
+						}
+					}
+					else
+					{
+						PutU8(out, (unsigned char)((runLength << 1) | 1));
+						PutU8(out, (unsigned char)byteDist(rng));
+					}
+					done += runLength;
+				}
+			}
+
+			//  Leave a gap before the next span, if there's room.
+			x += spanLength + uniform_int_distribution<int>(1, 8)(rng);
+		}
+	}
+
+	PutS16(out, 0);
+	return out;
+}
+
+//  The way CreateShapeTable() used to do it: one byte and one ImageDrawPixel() at a time.
+static void DecodeWithImageDrawPixel(ByteReader& shape, const Color* palette, Image& image)
+{
+	short W2 = shape.ReadS16();
+	short W1 = shape.ReadS16();
+	short H1 = shape.ReadS16();
+	short H2 = shape.ReadS16();
+	int width = W2 + W1 + 1;
+	int height = H1 + H2 + 1;
+
+	while (true)
+	{
+		unsigned short blockData = shape.ReadU16();
+		unsigned short spanLength = blockData >> 1;
+		unsigned short spanType = blockData & 1;
+
+		if (blockData == 0)
+		{
+			break;
+		}
+
+		short xStart = shape.ReadS16();
+		short yStart = shape.ReadS16();
+		xStart += width - W2 - 1;
+		yStart += height - H2 - 1;
+
+		if (spanType == 0)
+		{
+			for (int i = 0; i < spanLength; ++i)
+			{
+				ImageDrawPixel(&image, xStart + i, yStart, palette[shape.ReadU8()]);
+			}
+		}
+		else
+		{
+			int endX = xStart + spanLength;
+			while (xStart < endX)
+			{
+				unsigned char runData = shape.ReadU8();
+				int runLength = runData >> 1;
+				if ((runData & 1) == 0)
+				{
+					for (int i = 0; i < runLength; ++i)
+					{
+						ImageDrawPixel(&image, xStart + i, yStart, palette[shape.ReadU8()]);
+					}
+				}
+				else
+				{
+					Color value = palette[shape.ReadU8()];
+					for (int i = 0; i < runLength; ++i)
+					{
+						ImageDrawPixel(&image, xStart + i, yStart, value);
+					}
+				}
+				xStart += runLength;
+			}
+		}
+	}
+}
+
+void RunShapeDecodeBenchmark()
+{
+	const int frameCount = 4000;
+	const int passes = 10;
+
+	mt19937 rng(7777);
+
+	Color palette[256];
+	unsigned int packedPalette[256];
+	for (int i = 0; i < 256; ++i)
+	{
+		palette[i] = Color{ (unsigned char)i, (unsigned char)(255 - i), (unsigned char)(i * 7), 255 };
+	}
+	memcpy(packedPalette, palette, sizeof(packedPalette));
+
+	vector<vector<unsigned char> > frames(frameCount);
+	vector<Image> oldImages(frameCount);
+	vector<Image> newImages(frameCount);
+	double inputBytes = 0;
+	double outputBytes = 0;
+	for (int i = 0; i < frameCount; ++i)
+	{
+		int width, height;
+		frames[i] = MakeSyntheticFrame(rng, width, height);
+		oldImages[i] = GenImageColor(width, height, Color{ 0, 0, 0, 0 });
+		newImages[i] = GenImageColor(width, height, Color{ 0, 0, 0, 0 });
+		inputBytes += frames[i].size();
+		outputBytes += width * height * 4;
+	}
+
+	Log("Shape decode benchmark: " + to_string(frameCount) + " synthetic frames, " + to_string(int(inputBytes / 1024)) + " KB encoded, "
+		+ to_string(int(outputBytes / 1024)) + " KB decoded, " + to_string(passes) + " passes.");
+
+	double oldTime = Now();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (int i = 0; i < frameCount; ++i)
+		{
+			ByteReader reader(ByteSpan{ frames[i].data(), (unsigned int)frames[i].size() });
+			DecodeWithImageDrawPixel(reader, palette, oldImages[i]);
+		}
+	}
+	oldTime = Now() - oldTime;
+
+	double newTime = Now();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (int i = 0; i < frameCount; ++i)
+		{
+			ByteReader reader(ByteSpan{ frames[i].data(), (unsigned int)frames[i].size() });
+			ShapeFrameHeader header;
+			ReadShapeFrameHeader(reader, header);
+			DecodeShapeFrame(reader, header, packedPalette, (unsigned int*)newImages[i].data);
+		}
+	}
+	newTime = Now() - newTime;
+
+	int mismatches = 0;
+	for (int i = 0; i < frameCount; ++i)
+	{
+		if (memcmp(oldImages[i].data, newImages[i].data, oldImages[i].width * oldImages[i].height * 4) != 0)
+		{
+			++mismatches;
+		}
+		UnloadImage(oldImages[i]);
+		UnloadImage(newImages[i]);
+	}
+
+	Log("  ImageDrawPixel: " + to_string(oldTime) + "s, " + MBPerSecond(outputBytes * passes, oldTime) + " out, "
+		+ MBPerSecond(inputBytes * passes, oldTime) + " in");
+	Log("  ShapeDecoder:   " + to_string(newTime) + "s, " + MBPerSecond(outputBytes * passes, newTime) + " out, "
+		+ MBPerSecond(inputBytes * passes, newTime) + " in");
+	Log("  Speedup: " + to_string(oldTime / newTime) + "x, mismatched frames: " + to_string(mismatches));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//  Shape atlas
+////////////////////////////////////////////////////////////////////////////////
+
+bool RunShapeAtlasBenchmark()
+{
+	const int frameCount = 8000;
+
+	mt19937 rng(8888);
+
+	unsigned int packedPalette[256];
+	for (int i = 0; i < 256; ++i)
+	{
+		Color color = Color{ (unsigned char)i, (unsigned char)(255 - i), (unsigned char)(i * 7), 255 };
+		memcpy(&packedPalette[i], &color, sizeof(color));
+	}
+
+	vector<Image> images(frameCount);
+	for (int i = 0; i < frameCount; ++i)
+	{
+		int width, height;
+		vector<unsigned char> frame = MakeSyntheticFrame(rng, width, height);
+		images[i] = GenImageColor(width, height, Color{ 0, 0, 0, 0 });
+
+		ByteReader reader(ByteSpan{ frame.data(), (unsigned int)frame.size() });
+		ShapeFrameHeader header;
+		ReadShapeFrameHeader(reader, header);
+		DecodeShapeFrame(reader, header, packedPalette, (unsigned int*)images[i].data);
+	}
+
+	Log("Shape atlas benchmark: " + to_string(frameCount) + " synthetic frames.");
+
+	ShapeAtlas atlas;
+	double packTime = Now();
+	atlas.Pack(images);
+	packTime = Now() - packTime;
+	atlas.LogStats();
+
+	//  Reading the pages back needs them still in memory, so no Upload().
+	int mismatches = 0;
+	for (int i = 0; i < frameCount; ++i)
+	{
+		const AtlasRect& rect = atlas.GetRect(i);
+		bool matches = rect.m_page >= 0;
+		for (int y = 0; matches && y < images[i].height; ++y)
+		{
+			const Image& page = atlas.GetPageImage(rect.m_page);
+			const unsigned int* src = (const unsigned int*)images[i].data + y * images[i].width;
+			const unsigned int* dest = (const unsigned int*)page.data + (int(rect.m_source.y) + y) * page.width + int(rect.m_source.x);
+			matches = memcmp(src, dest, images[i].width * 4) == 0;
+		}
+
+		if (!matches)
+		{
+			++mismatches;
+		}
+		UnloadImage(images[i]);
+	}
+
+	Log("  Packed in " + to_string(packTime) + "s, mismatched frames: " + to_string(mismatches));
+	return mismatches == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//  IREG parsing
+////////////////////////////////////////////////////////////////////////////////
+
+//  Objects, eggs, open and closed containers (including containers opened
+//  inside other containers), stray bytes and a truncated record at the end.
+static vector<unsigned char> MakeSyntheticIREG(mt19937& rng, int records)
+{
+	vector<unsigned char> out;
+	uniform_int_distribution<int> byteDist(0, 255);
+	uniform_int_distribution<int> kindDist(0, 19);
+	uniform_int_distribution<int> shapeDist(150, 1023);
+
+	for (int i = 0; i < records; ++i)
+	{
+		int kind = kindDist(rng);
+		int shape = shapeDist(rng);
+		if (kind == 0)
+		{
+			shape = 275;
+		}
+		else if (kind == 1)
+		{
+			shape = 607;
+		}
+
+		if (kind < 14) //  Object.
+		{
+			PutU8(out, 6);
+			PutU8(out, (unsigned char)byteDist(rng));
+			PutU8(out, (unsigned char)byteDist(rng));
+			PutS16(out, (short)(shape | (uniform_int_distribution<int>(0, 31)(rng) << 10)));
+			PutU8(out, (unsigned char)byteDist(rng));
+			PutU8(out, (unsigned char)byteDist(rng));
+		}
+		else if (kind < 17) //  Container or egg.
+		{
+			PutU8(out, 12);
+			PutU8(out, (unsigned char)byteDist(rng));
+			PutU8(out, (unsigned char)byteDist(rng));
+			PutS16(out, (short)shape);
+			for (int j = 0; j < 7; ++j)
+			{
+				PutU8(out, (unsigned char)byteDist(rng));
+			}
+			PutU8(out, (unsigned char)(kind == 16 ? 1 : 0));
+		}
+		else if (kind < 19) //  Close container.
+		{
+			PutU8(out, 1);
+		}
+		else //  Something the loader doesn't know about.
+		{
+			PutU8(out, 3);
+		}
+	}
+
+	//  Half a record.
+	PutU8(out, 6);
+	PutU8(out, 1);
+	return out;
+}
+
+struct IREGPlacement
+{
+	int id;
+	int shape;
+	int container;
+
+	bool operator==(const IREGPlacement& other) const { return id == other.id && shape == other.shape && container == other.container; }
+};
+
+//  What the old LoadIREG() did, reduced to which ID ends up in which container.
+static void ReferenceIREG(ByteSpan data, int& nextId, vector<IREGPlacement>& placements)
+{
+	ByteReader ireg(data);
+	int containerId = 0;
+	bool containerOpen = false;
+
+	while (!ireg.Eof())
+	{
+		unsigned char length = ireg.ReadU8();
+		if (length == 6)
+		{
+			ireg.Skip(2);
+			int shape = ireg.ReadU16() & 0x3ff;
+			ireg.Skip(2);
+			if (ireg.Failed())
+			{
+				break;
+			}
+
+			if (shape != 275 && shape != 607 && shape != 0)
+			{
+				int id = nextId++;
+				placements.push_back(IREGPlacement{ id, shape, containerOpen ? containerId : -1 });
+			}
+		}
+		else if (length == 12)
+		{
+			ireg.Skip(2);
+			int shape = ireg.ReadU16() & 0x3ff;
+			ireg.Skip(7);
+			unsigned char eggOrContainer = ireg.ReadU8();
+			if (ireg.Failed())
+			{
+				break;
+			}
+
+			int id = nextId++;
+			placements.push_back(IREGPlacement{ id, shape, -1 });
+			if (eggOrContainer == 0)
+			{
+				containerOpen = true;
+				containerId = id;
+			}
+		}
+		else if (length == 1)
+		{
+			containerOpen = false;
+		}
+	}
+}
+
+//  What CommitIREGRecords() did with the parsed records: which of the objects
+//  it created ended up in which container's inventory.
+static void GetIREGPlacements(const vector<ObjectHandle>& created, vector<IREGPlacement>& placements)
+{
+	unordered_map<ObjectHandle, int> indices;
+	for (int i = 0; i < int(created.size()); ++i)
+	{
+		indices[created[i]] = i;
+	}
+
+	vector<int> containers(created.size(), -1);
+	for (int i = 0; i < int(created.size()); ++i)
+	{
+		for (ObjectHandle item : g_ObjectList.Get(created[i])->GetInventory())
+		{
+			auto index = indices.find(item);
+			if (index != indices.end())
+			{
+				containers[index->second] = i;
+			}
+		}
+	}
+
+	for (int i = 0; i < int(created.size()); ++i)
+	{
+		placements.push_back(IREGPlacement{ i, g_ObjectList.GetRecord(created[i])->m_shape, containers[i] });
+	}
+}
+
+bool RunIREGBenchmark()
+{
+	const int fileCount = 144;
+	const int passes = 20;
+
+	mt19937 rng(7777);
+	vector<vector<unsigned char> > files(fileCount);
+	double inputBytes = 0;
+	for (int i = 0; i < fileCount; ++i)
+	{
+		files[i] = MakeSyntheticIREG(rng, uniform_int_distribution<int>(200, 4000)(rng));
+		inputBytes += files[i].size();
+	}
+
+	//  Check the nesting first, by having the loader really make the objects.
+	//  Init() asks for the objects' config.
+	if (!g_ResourceManager)
+	{
+		g_ResourceManager = make_unique<ResourceManager>();
+	}
+
+	vector<IREGPlacement> expected;
+	vector<IREGPlacement> actual;
+	vector<ObjectHandle> created;
+	int expectedId = 0;
+	vector<vector<IREGRecord> > records(fileCount);
+	for (int i = 0; i < fileCount; ++i)
+	{
+		ByteSpan data{ files[i].data(), (unsigned int)files[i].size() };
+		ReferenceIREG(data, expectedId, expected);
+		LoadingState::ParseIREG(data, i % 12, i / 12, records[i]);
+		LoadingState::CommitIREGRecords(records[i], &created);
+	}
+	GetIREGPlacements(created, actual);
+	g_ObjectList.Clear();
+
+	int contained = 0;
+	for (auto& placement : expected)
+	{
+		if (placement.container >= 0)
+		{
+			++contained;
+		}
+	}
+
+	bool matched = expected == actual;
+	Log("IREG benchmark: " + to_string(fileCount) + " synthetic files, " + to_string(int(inputBytes / 1024)) + " KB, "
+		+ to_string(expected.size()) + " objects, " + to_string(contained) + " in containers.");
+	Log(string("  Container nesting matches the serial loader: ") + (matched ? "yes" : "NO"), matched ? LOG_INFO : LOG_ERROR);
+
+	if (!g_ThreadPool)
+	{
+		g_ThreadPool = make_unique<ThreadPool>();
+		g_ThreadPool->Init();
+	}
+
+	double serialTime = Now();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (int i = 0; i < fileCount; ++i)
+		{
+			records[i].clear();
+			LoadingState::ParseIREG(ByteSpan{ files[i].data(), (unsigned int)files[i].size() }, i % 12, i / 12, records[i]);
+		}
+	}
+	serialTime = Now() - serialTime;
+
+	double parallelTime = Now();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		g_ThreadPool->ParallelFor(0, fileCount, [&](int i)
+			{
+				records[i].clear();
+				LoadingState::ParseIREG(ByteSpan{ files[i].data(), (unsigned int)files[i].size() }, i % 12, i / 12, records[i]);
+			});
+	}
+	parallelTime = Now() - parallelTime;
+
+	Log("  Serial:   " + to_string(serialTime) + "s, " + MBPerSecond(inputBytes * passes, serialTime));
+	Log("  Parallel: " + to_string(parallelTime) + "s, " + MBPerSecond(inputBytes * passes, parallelTime) + " ("
+		+ to_string(g_ThreadPool->GetNumThreads() + 1) + " threads)");
+
+	return matched;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//  Chunk object map
+////////////////////////////////////////////////////////////////////////////////
+
+//  What GetAllUnitsWithinRange() used to do: look at every object.
+static void ScanRange(float x, float z, float range, vector<ObjectHandle>& out)
+{
+	for (ObjectStore::iterator unit = g_ObjectList.begin(); unit != g_ObjectList.end(); ++unit)
+	{
+		const ObjectRecord& record = unit.GetRecord();
+		if (IsDistanceLessThan(x, z, record.m_pos.x, record.m_pos.z, range))
+		{
+			out.push_back(unit.GetHandle());
+		}
+	}
+}
+
+//  Where DoCameraMovement() puts the camera.
+static Camera MakeGameCamera(Vector3 target, float distance, float rotation)
+{
+	Camera camera = {};
+	camera.target = target;
+	camera.position = Vector3Add(target, Vector3RotateByAxisAngle(Vector3{ distance, distance, distance }, Vector3{ 0, 1, 0 }, rotation));
+	camera.up = Vector3{ 0, 1, 0 };
+	camera.fovy = distance;
+	camera.projection = CAMERA_ORTHOGRAPHIC;
+	return camera;
+}
+
+//  What GetMouseRay() works out for a point on the screen, x and y from -1 to 1.
+static Ray MakeScreenRay(const Camera& camera, float aspect, float x, float y)
+{
+	double top = camera.fovy / 2.0;
+	double right = top * aspect;
+	Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+	Matrix projection = MatrixOrtho(-right, right, -top, top, 0.01, 1000.0);
+
+	Vector3 nearPoint = Vector3Unproject(Vector3{ x, y, 0 }, projection, view);
+	Vector3 farPoint = Vector3Unproject(Vector3{ x, y, 1 }, projection, view);
+	Vector3 cameraPoint = Vector3Unproject(Vector3{ x, y, -1 }, projection, view);
+	return Ray{ cameraPoint, Vector3Normalize(Vector3Subtract(farPoint, nearPoint)) };
+}
+
+static bool SameHandles(vector<ObjectHandle> a, vector<ObjectHandle> b)
+{
+	sort(a.begin(), a.end());
+	sort(b.begin(), b.end());
+	return a == b;
+}
+
+//  Made-up shapes, some drawn as billboards and some as cuboids, so the boxes
+//  sit on both sides of their positions.
+static void MakeSyntheticShapes(int shapeCount)
+{
+	for (int shape = 0; shape < shapeCount; ++shape)
+	{
+		ShapeData& shapeData = g_shapeTable[shape][0];
+		shapeData.m_shape = shape;
+		shapeData.m_frame = 0;
+		shapeData.SetDrawType(shape % 3 == 0 ? ShapeDrawType::OBJECT_DRAW_CUBOID : ShapeDrawType::OBJECT_DRAW_BILLBOARD);
+		g_objectTable[shape].m_width = float(1 + shape % 4);
+		g_objectTable[shape].m_depth = float(1 + (shape / 4) % 4);
+		g_objectTable[shape].m_height = float(1 + (shape / 16) % 8);
+	}
+}
+
+//  An object of one of the made-up shapes, filed in g_chunkObjectMap.
+static ObjectHandle MakeSyntheticObject(int shape, Vector3 pos)
+{
+	ObjectHandle handle = g_ObjectList.Allocate();
+	U7Object* object = g_ObjectList.Create(handle);
+	object->m_ID = handle;
+	object->m_shapeData = &g_shapeTable[shape][0];
+	object->SetInitialPos(pos);
+	return handle;
+}
+
+static bool LogMatched(const string& what, bool matched)
+{
+	Log("  " + what + ": " + (matched ? "yes" : "NO"), matched ? LOG_INFO : LOG_ERROR);
+	return matched;
+}
+
+static const int SPATIAL_CHECKS = 200;
+static const float SPATIAL_HEIGHT_CUTOFF = 4;
+static const float SPATIAL_ASPECT = 16.0f / 9.0f;
+static const float SPATIAL_WORLD_SIZE = float(ChunkObjectMap::MAP_CHUNKS * ChunkObjectMap::CHUNK_SIZE);
+
+//  Range, rectangle and ray queries on g_chunkObjectMap against looking at
+//  every object, then again after moving and deleting some.
+static bool BenchmarkMapQueries(mt19937& rng, const vector<ObjectHandle>& handles)
+{
+	const int rangeQueries = 2000;
+	uniform_real_distribution<float> anywhere(0, SPATIAL_WORLD_SIZE - 1);
+
+	//  Range queries, every object against the map.
+	vector<Vector3> points;
+	for (int i = 0; i < rangeQueries; ++i)
+	{
+		points.push_back(Vector3{ anywhere(rng), 0, anywhere(rng) });
+		points.back().y = uniform_real_distribution<float>(4, 40)(rng);
+	}
+
+	vector<ObjectHandle> expected;
+	vector<ObjectHandle> actual;
+	bool matched = true;
+
+	size_t found = 0;
+	double scanTime = Now();
+	for (int i = 0; i < SPATIAL_CHECKS; ++i)
+	{
+		expected.clear();
+		ScanRange(points[i].x, points[i].z, points[i].y, expected);
+		found += expected.size();
+	}
+	scanTime = (Now() - scanTime) / SPATIAL_CHECKS;
+
+	double mapTime = Now();
+	for (int i = 0; i < rangeQueries; ++i)
+	{
+		actual.clear();
+		g_chunkObjectMap.GetObjectsInRange(points[i].x, points[i].z, points[i].y, actual);
+	}
+	mapTime = (Now() - mapTime) / rangeQueries;
+
+	for (int i = 0; i < SPATIAL_CHECKS; ++i)
+	{
+		expected.clear();
+		actual.clear();
+		ScanRange(points[i].x, points[i].z, points[i].y, expected);
+		g_chunkObjectMap.GetObjectsInRange(points[i].x, points[i].z, points[i].y, actual);
+		matched = matched && SameHandles(expected, actual);
+	}
+
+	Log("  Range, radius 4 to 40: scan " + to_string(scanTime * 1000000) + " us, chunk map " + to_string(mapTime * 1000000) + " us, "
+		+ to_string(scanTime / mapTime) + "x, " + to_string(found / SPATIAL_CHECKS) + " objects each.");
+
+	//  Rectangles.
+	for (int i = 0; i < SPATIAL_CHECKS; ++i)
+	{
+		float left = anywhere(rng);
+		float top = anywhere(rng);
+		float right = left + uniform_real_distribution<float>(0, 100)(rng);
+		float bottom = top + uniform_real_distribution<float>(0, 100)(rng);
+
+		expected.clear();
+		actual.clear();
+		for (ObjectStore::iterator unit = g_ObjectList.begin(); unit != g_ObjectList.end(); ++unit)
+		{
+			const Vector3& pos = unit.GetRecord().m_pos;
+			if (pos.x >= left && pos.x <= right && pos.z >= top && pos.z <= bottom)
+			{
+				expected.push_back(unit.GetHandle());
+			}
+		}
+		g_chunkObjectMap.GetObjectsInRect(left, top, right, bottom, actual);
+		matched = matched && SameHandles(expected, actual);
+	}
+
+	//  Rays down from about where the camera would be, against every box.
+	vector<ChunkObjectMap::RayHit> hits;
+	double rayScanTime = 0;
+	double rayMapTime = 0;
+	for (int i = 0; i < SPATIAL_CHECKS; ++i)
+	{
+		Vector3 target{ anywhere(rng), 0, anywhere(rng) };
+		Vector3 eye = Vector3Add(target, Vector3{ uniform_real_distribution<float>(-60, 60)(rng), uniform_real_distribution<float>(20, 80)(rng),
+			uniform_real_distribution<float>(-60, 60)(rng) });
+		Ray ray{ eye, Vector3Normalize(Vector3Subtract(target, eye)) };
+
+		expected.clear();
+		double start = Now();
+		for (ObjectStore::iterator unit = g_ObjectList.begin(); unit != g_ObjectList.end(); ++unit)
+		{
+			if (GetRayCollisionBox(ray, unit.GetRecord().m_boundingBox).hit)
+			{
+				expected.push_back(unit.GetHandle());
+			}
+		}
+		rayScanTime += Now() - start;
+
+		hits.clear();
+		start = Now();
+		g_chunkObjectMap.GetObjectsAlongRay(ray, hits);
+		rayMapTime += Now() - start;
+
+		actual.clear();
+		for (size_t hit = 0; hit < hits.size(); ++hit)
+		{
+			actual.push_back(hits[hit].m_handle);
+			matched = matched && (hit == 0 || hits[hit - 1].m_distance <= hits[hit].m_distance);
+		}
+		matched = matched && SameHandles(expected, actual);
+	}
+
+	Log("  Ray: scan " + to_string(rayScanTime / SPATIAL_CHECKS * 1000000) + " us, chunk map " + to_string(rayMapTime / SPATIAL_CHECKS * 1000000)
+		+ " us, " + to_string(rayScanTime / rayMapTime) + "x.");
+
+	//  Move some objects around and delete some, then check the map kept up.
+	size_t moved = handles.size() / 10;
+	for (size_t i = 0; i < moved; ++i)
+	{
+		g_ObjectList.Get(handles[i])->SetPos(Vector3{ floorf(anywhere(rng)), 0, floorf(anywhere(rng)) });
+	}
+	for (size_t i = moved; i < moved * 2; ++i)
+	{
+		g_ObjectList.Remove(handles[i]);
+	}
+	matched = matched && g_chunkObjectMap.GetObjectCount() == g_ObjectList.size();
+	for (int i = 0; i < SPATIAL_CHECKS; ++i)
+	{
+		expected.clear();
+		actual.clear();
+		ScanRange(points[i].x, points[i].z, points[i].y, expected);
+		g_chunkObjectMap.GetObjectsInRange(points[i].x, points[i].z, points[i].y, actual);
+		matched = matched && SameHandles(expected, actual);
+	}
+
+	return LogMatched("Range, rectangle and ray results match a scan of every object, including after moves and deletes", matched);
+}
+
+//  The visible object list built from the chunks in view against testing
+//  every object against the frustum and sorting them.
+static bool BenchmarkVisibleSetBuild(mt19937& rng)
+{
+	const float zooms[] = { 26, 37, 48 };
+	uniform_real_distribution<float> anywhere(0, SPATIAL_WORLD_SIZE - 1);
+
+	VisibleObjectSet visible;
+	vector<ObjectHandle> expected;
+	bool matched = true;
+	for (float zoom : zooms)
+	{
+		double scanTime = 0;
+		double mapTime = 0;
+		size_t considered = 0;
+		size_t accepted = 0;
+		for (int i = 0; i < SPATIAL_CHECKS; ++i)
+		{
+			Camera camera = MakeGameCamera(Vector3{ anywhere(rng), 0, anywhere(rng) }, zoom, uniform_real_distribution<float>(0, 2 * PI)(rng));
+			CameraFrustum frustum;
+			frustum.Set(camera, SPATIAL_ASPECT, 2);
+
+			expected.clear();
+			double start = Now();
+			for (ObjectStore::iterator node = g_ObjectList.begin(); node != g_ObjectList.end(); ++node)
+			{
+				ObjectRecord& record = node.GetRecord();
+				if (record.m_pos.y <= SPATIAL_HEIGHT_CUTOFF && frustum.IsBoxVisible(record.m_boundingBox))
+				{
+					record.m_distanceFromCamera = Vector3Distance(record.m_pos, camera.position) - record.m_pos.y;
+					expected.push_back(node.GetHandle());
+				}
+			}
+			sort(expected.begin(), expected.end(),
+				[](ObjectHandle a, ObjectHandle b) { return g_ObjectList.GetRecord(a)->m_distanceFromCamera > g_ObjectList.GetRecord(b)->m_distanceFromCamera; });
+			scanTime += Now() - start;
+
+			start = Now();
+			visible.Build(camera, frustum, SPATIAL_HEIGHT_CUTOFF);
+			mapTime += Now() - start;
+
+			considered += visible.GetConsidered();
+			accepted += visible.GetAccepted();
+			matched = matched && SameHandles(expected, visible.GetObjects());
+		}
+
+		Log("  Visible set, zoom " + to_string(int(zoom)) + ": scan " + to_string(scanTime / SPATIAL_CHECKS * 1000000) + " us, chunk map "
+			+ to_string(mapTime / SPATIAL_CHECKS * 1000000) + " us, " + to_string(scanTime / mapTime) + "x, " + to_string(considered / SPATIAL_CHECKS)
+			+ " objects considered and " + to_string(accepted / SPATIAL_CHECKS) + " accepted.");
+	}
+
+	return LogMatched("Visible set matches a scan of every object", matched);
+}
+
+//  What gets culled at each zoom: the terrain chunks and objects the old tests
+//  let through (a square of chunks sized from fovy, and a circle of 1.5 times
+//  the camera distance around the target) against the frustum.  Also checks
+//  the terrain finds the same chunks as testing every chunk in the map.  The
+//  frustum's box test alone lets through ground boxes just off the corners of
+//  the footprint; with the footprint's bounds as well it's exact.
+static bool BenchmarkFrustumCulling(mt19937& rng)
+{
+	const float zooms[] = { 26, 37, 48 };
+	uniform_real_distribution<float> anywhere(0, SPATIAL_WORLD_SIZE - 1);
+
+	Terrain terrain;
+	VisibleObjectSet visible;
+	bool matched = true;
+	for (float zoom : zooms)
+	{
+		size_t oldChunks = 0;
+		size_t newChunks = 0;
+		size_t oldObjects = 0;
+		size_t newObjects = 0;
+		for (int i = 0; i < SPATIAL_CHECKS; ++i)
+		{
+			Camera camera = MakeGameCamera(Vector3{ anywhere(rng), 0, anywhere(rng) }, zoom, uniform_real_distribution<float>(0, 2 * PI)(rng));
+			CameraFrustum frustum;
+			frustum.Set(camera, SPATIAL_ASPECT, 2);
+
+			int range = int(camera.fovy) / 16 + 1;
+			int chunkx = int(camera.target.x) / 16;
+			int chunkz = int(camera.target.z) / 16;
+			for (int x = max(chunkx - range, 0); x <= min(chunkx + range + 1, ChunkObjectMap::MAP_CHUNKS - 1); ++x)
+			{
+				oldChunks += min(chunkz + range + 1, ChunkObjectMap::MAP_CHUNKS - 1) - max(chunkz - range, 0) + 1;
+			}
+			terrain.FindVisibleChunks(frustum);
+			newChunks += terrain.GetNumberOfVisibleChunks();
+
+			Rectangle bounds = frustum.GetFootprintBounds(0, 0);
+			size_t found = 0;
+			for (int z = 0; z < ChunkObjectMap::MAP_CHUNKS; ++z)
+			{
+				for (int x = 0; x < ChunkObjectMap::MAP_CHUNKS; ++x)
+				{
+					BoundingBox chunk{ { x * 16.0f, 0, z * 16.0f }, { x * 16.0f + 16, 0, z * 16.0f + 16 } };
+					if (chunk.max.x >= bounds.x && chunk.min.x <= bounds.x + bounds.width && chunk.max.z >= bounds.y && chunk.min.z <= bounds.y + bounds.height
+						&& frustum.IsBoxVisible(chunk))
+					{
+						++found;
+						matched = matched && terrain.IsChunkVisible(x, z);
+					}
+				}
+			}
+			matched = matched && found == terrain.m_visibleChunks.size();
+
+			for (ObjectStore::iterator node = g_ObjectList.begin(); node != g_ObjectList.end(); ++node)
+			{
+				const ObjectRecord& record = node.GetRecord();
+				if (Vector3Distance(record.m_pos, camera.target) - record.m_pos.y < zoom * 1.5f && record.m_pos.y <= SPATIAL_HEIGHT_CUTOFF)
+				{
+					++oldObjects;
+				}
+			}
+
+			visible.Build(camera, frustum, SPATIAL_HEIGHT_CUTOFF);
+			newObjects += visible.GetAccepted();
+		}
+
+		Log("  Zoom " + to_string(int(zoom)) + ": terrain chunks " + to_string(oldChunks / SPATIAL_CHECKS) + " before, " + to_string(newChunks / SPATIAL_CHECKS)
+			+ " culled; objects " + to_string(oldObjects / SPATIAL_CHECKS) + " before, " + to_string(newObjects / SPATIAL_CHECKS) + " culled.");
+	}
+
+	return LogMatched("Terrain chunks in view match a test of every chunk", matched);
+}
+
+//  A slow pan, with the list kept up to date against made again every tick.
+//  Every so often a few objects on screen move, appear and disappear.
+static bool BenchmarkVisibleSetPan()
+{
+	const int panTicks = 1000;
+	VisibleObjectSet panning;
+	VisibleObjectSet rebuilt;
+	Camera camera = MakeGameCamera(Vector3{ SPATIAL_WORLD_SIZE / 2, 0, SPATIAL_WORLD_SIZE / 2 }, 48, 0);
+	vector<ObjectHandle> panObjects;
+	bool matched = true;
+	double updateTime = 0;
+	double rebuildTime = 0;
+	double stillTime = 0;
+	size_t churn = 0;
+	size_t panConsidered = 0;
+	for (int tick = 0; tick < panTicks; ++tick)
+	{
+		camera = MakeGameCamera(Vector3Add(camera.target, Vector3{ .1f, 0, .05f }), 48, 0);
+		CameraFrustum frustum;
+		frustum.Set(camera, SPATIAL_ASPECT, 2);
+
+		if (tick % 100 == 50)
+		{
+			for (ObjectHandle handle : panObjects)
+			{
+				g_ObjectList.Remove(handle);
+			}
+			panObjects.clear();
+
+			for (int i = 0; i < 10; ++i)
+			{
+				panObjects.push_back(MakeSyntheticObject(i, Vector3{ camera.target.x + i * 5 - 25, 0, camera.target.z - i * 3 }));
+			}
+
+			for (size_t i = 0; i < rebuilt.GetObjects().size(); i += 40)
+			{
+				U7Object* object = g_ObjectList.Get(rebuilt.GetObjects()[i]);
+				if (object != nullptr)
+				{
+					object->SetPos(Vector3Add(object->GetPos(), Vector3{ 1, 0, -2 }));
+				}
+			}
+		}
+
+		double start = Now();
+		panning.Update(camera, frustum, SPATIAL_HEIGHT_CUTOFF);
+		updateTime += Now() - start;
+		churn += panning.GetAdded() + panning.GetRemoved();
+		panConsidered += panning.GetConsidered();
+
+		start = Now();
+		rebuilt.Build(camera, frustum, SPATIAL_HEIGHT_CUTOFF);
+		rebuildTime += Now() - start;
+
+		start = Now();
+		matched = matched && !panning.Update(camera, frustum, SPATIAL_HEIGHT_CUTOFF);
+		stillTime += Now() - start;
+
+		matched = matched && SameHandles(rebuilt.GetObjects(), panning.GetObjects());
+		for (size_t i = 1; i < panning.GetObjects().size(); ++i)
+		{
+			matched = matched && g_ObjectList.GetRecord(panning.GetObjects()[i - 1])->m_distanceFromCamera >= g_ObjectList.GetRecord(panning.GetObjects()[i])->m_distanceFromCamera;
+		}
+	}
+
+	Log("  Panning " + to_string(panTicks) + " ticks: rebuilt " + to_string(rebuildTime / panTicks * 1000000) + " us, kept up to date "
+		+ to_string(updateTime / panTicks * 1000000) + " us with " + to_string(panConsidered / panTicks) + " objects considered and "
+		+ to_string(float(churn) / panTicks) + " added or removed a tick, still camera " + to_string(stillTime / panTicks * 1000000) + " us.");
+
+	for (ObjectHandle handle : panObjects)
+	{
+		g_ObjectList.Remove(handle);
+	}
+
+	return LogMatched("Visible set kept up to date matches it made again every tick", matched);
+}
+
+bool RunSpatialBenchmark()
+{
+	const int objectCount = 400000;
+	const int shapeCount = 256;
+
+	mt19937 rng(2020);
+	uniform_real_distribution<float> anywhere(0, SPATIAL_WORLD_SIZE - 1);
+
+	MakeSyntheticShapes(shapeCount);
+
+	g_ObjectList.Reserve(objectCount);
+	vector<ObjectHandle> handles;
+	handles.reserve(objectCount);
+	double createTime = Now();
+	for (int i = 0; i < objectCount; ++i)
+	{
+		handles.push_back(MakeSyntheticObject(i % shapeCount, Vector3{ floorf(anywhere(rng)), float(i % 3), floorf(anywhere(rng)) }));
+	}
+	createTime = Now() - createTime;
+
+	Log("Spatial benchmark: " + to_string(objectCount) + " synthetic objects, filed in " + to_string(createTime) + "s, boxes reach "
+		+ to_string(g_chunkObjectMap.GetChunkMargin()) + " chunks over.");
+
+	//  Each runs even if one before it failed, so every result gets logged.
+	bool matched = BenchmarkMapQueries(rng, handles);
+	matched = BenchmarkVisibleSetBuild(rng) && matched;
+	matched = BenchmarkFrustumCulling(rng) && matched;
+	matched = BenchmarkVisibleSetPan() && matched;
+
+	g_ObjectList.Clear();
+	return matched && g_chunkObjectMap.GetObjectCount() == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//  Picking
+////////////////////////////////////////////////////////////////////////////////
+
+//  Chunk types full of template objects of the made-up shapes, spread over
+//  the whole map.
+static void MakeSyntheticTemplates(mt19937& rng, int shapeCount)
+{
+	const int chunkTypes = 64;
+	uniform_int_distribution<int> shapeDist(150, shapeCount - 1);
+	uniform_int_distribution<int> tileDist(0, 15);
+	for (int chunkType = 0; chunkType < chunkTypes; ++chunkType)
+	{
+		for (int i = 0; i < 20; ++i)
+		{
+			g_worldTiles.SetChunkTile(chunkType, tileDist(rng), tileDist(rng), uint16_t(shapeDist(rng)));
+		}
+	}
+
+	uniform_int_distribution<int> chunkTypeDist(0, chunkTypes - 1);
+	for (int chunkz = 0; chunkz < WorldTiles::MAP_CHUNKS; ++chunkz)
+	{
+		for (int chunkx = 0; chunkx < WorldTiles::MAP_CHUNKS; ++chunkx)
+		{
+			g_worldTiles.SetChunkType(chunkx, chunkz, uint16_t(chunkTypeDist(rng)));
+		}
+	}
+
+	g_chunkTemplates.Build(g_worldTiles);
+}
+
+//  Everything the ray goes through, by testing every object and every template
+//  object around where the ray meets the ground, nearest first.  Template
+//  objects are given as their tile, z * WORLD_TILES + x, above every handle.
+static void ScanPick(const Ray& ray, vector<pair<float, uint64_t> >& out)
+{
+	out.clear();
+	for (ObjectStore::iterator unit = g_ObjectList.begin(); unit != g_ObjectList.end(); ++unit)
+	{
+		const ObjectRecord& record = unit.GetRecord();
+		if (!record.IsDrawn() || record.m_pos.y > SPATIAL_HEIGHT_CUTOFF)
+		{
+			continue;
+		}
+
+		RayCollision collision = GetRayCollisionBox(ray, record.m_boundingBox);
+		if (collision.hit)
+		{
+			out.push_back(make_pair(collision.distance, uint64_t(unit.GetHandle())));
+		}
+	}
+
+	//  No template object is tall enough to be hit further than this from there.
+	if (g_chunkTemplates.IsBuilt())
+	{
+		const float around = 64;
+		float toGround = -ray.position.y / ray.direction.y;
+		float x = ray.position.x + ray.direction.x * toGround;
+		float z = ray.position.z + ray.direction.z * toGround;
+
+		vector<ChunkTemplateInstance> instances;
+		g_chunkTemplates.GetInstancesInRect(x - around, z - around, x + around, z + around, instances);
+		for (const ChunkTemplateInstance& instance : instances)
+		{
+			RayCollision collision = GetRayCollisionBox(ray, instance.GetBoundingBox());
+			if (collision.hit)
+			{
+				uint64_t tile = uint64_t(instance.m_pos.z) * WorldTiles::WORLD_TILES + uint64_t(instance.m_pos.x);
+				out.push_back(make_pair(collision.distance, (uint64_t(1) << 32) + tile));
+			}
+		}
+	}
+
+	sort(out.begin(), out.end());
+}
+
+//  Picks at random points on random screens, and checks the hits and the nearest
+//  one against ScanPick().  Also times the click handler's old way of doing it:
+//  going through the visible list nearest first, working the mouse ray out again
+//  for each object.
+static bool BenchmarkPicks(mt19937& rng, const string& what)
+{
+	uniform_real_distribution<float> anywhere(0, SPATIAL_WORLD_SIZE - 1);
+
+	VisibleObjectSet visible;
+	ObjectPicker picker;
+	vector<pair<float, uint64_t> > expected;
+	vector<uint64_t> expectedKeys;
+	vector<uint64_t> actualKeys;
+	bool matched = true;
+	double oldPickTime = 0;
+	double pickTime = 0;
+	size_t pickHits = 0;
+	size_t templateHits = 0;
+	size_t pickConsidered = 0;
+	for (int i = 0; i < SPATIAL_CHECKS; ++i)
+	{
+		Camera camera = MakeGameCamera(Vector3{ anywhere(rng), 0, anywhere(rng) }, 48, uniform_real_distribution<float>(0, 2 * PI)(rng));
+		CameraFrustum frustum;
+		frustum.Set(camera, SPATIAL_ASPECT, 2);
+		visible.Build(camera, frustum, SPATIAL_HEIGHT_CUTOFF);
+
+		float x = uniform_real_distribution<float>(-1, 1)(rng);
+		float y = uniform_real_distribution<float>(-1, 1)(rng);
+
+		double start = Now();
+		const vector<ObjectHandle>& objects = visible.GetObjects();
+		for (auto node = objects.rbegin(); node != objects.rend(); ++node)
+		{
+			Ray ray = MakeScreenRay(camera, SPATIAL_ASPECT, x, y);
+			if (GetRayCollisionBox(ray, g_ObjectList.GetRecord(*node)->m_boundingBox).hit)
+			{
+				break;
+			}
+		}
+		oldPickTime += Now() - start;
+
+		start = Now();
+		Ray ray = MakeScreenRay(camera, SPATIAL_ASPECT, x, y);
+		picker.Pick(ray, SPATIAL_HEIGHT_CUTOFF);
+		pickTime += Now() - start;
+		pickHits += picker.GetHits().size();
+		pickConsidered += picker.GetConsidered();
+
+		ScanPick(ray, expected);
+		expectedKeys.clear();
+		for (auto& hit : expected)
+		{
+			expectedKeys.push_back(hit.second);
+		}
+
+		actualKeys.clear();
+		for (size_t hit = 0; hit < picker.GetHits().size(); ++hit)
+		{
+			const PickHit& pickHit = picker.GetHits()[hit];
+			if (pickHit.m_kind == PickHit::TEMPLATE)
+			{
+				const Vector3& pos = picker.GetInstance(pickHit).m_pos;
+				actualKeys.push_back((uint64_t(1) << 32) + uint64_t(pos.z) * WorldTiles::WORLD_TILES + uint64_t(pos.x));
+				++templateHits;
+			}
+			else
+			{
+				actualKeys.push_back(pickHit.m_handle);
+			}
+			matched = matched && (hit == 0 || picker.GetHits()[hit - 1].m_distance <= pickHit.m_distance);
+		}
+
+		sort(expectedKeys.begin(), expectedKeys.end());
+		sort(actualKeys.begin(), actualKeys.end());
+		matched = matched && expectedKeys == actualKeys;
+
+		//  Two boxes can be hit at the same distance, so it's the distance that
+		//  has to match.
+		const PickHit* nearest = picker.GetNearest();
+		matched = matched && (nearest == nullptr) == expected.empty();
+		matched = matched && (nearest == nullptr || nearest->m_distance == expected[0].first);
+	}
+
+	Log("  " + what + ": visible list " + to_string(oldPickTime / SPATIAL_CHECKS * 1000000) + " us, picker " + to_string(pickTime / SPATIAL_CHECKS * 1000000)
+		+ " us, " + to_string(pickConsidered / SPATIAL_CHECKS) + " boxes tested for " + to_string(float(pickHits) / SPATIAL_CHECKS) + " hits, "
+		+ to_string(float(templateHits) / SPATIAL_CHECKS) + " of them template objects.");
+
+	return LogMatched(what + " hits and nearest hit match testing everything", matched);
+}
+
+bool RunPickingBenchmark()
+{
+	const int objectCount = 400000;
+	const int shapeCount = 256;
+
+	mt19937 rng(4040);
+	uniform_real_distribution<float> anywhere(0, SPATIAL_WORLD_SIZE - 1);
+
+	MakeSyntheticShapes(shapeCount);
+
+	g_ObjectList.Reserve(objectCount);
+	for (int i = 0; i < objectCount; ++i)
+	{
+		MakeSyntheticObject(i % shapeCount, Vector3{ floorf(anywhere(rng)), float(i % 3), floorf(anywhere(rng)) });
+	}
+
+	Log("Picking benchmark: " + to_string(objectCount) + " synthetic objects, at zoom 48.");
+
+	//  Each runs even if the one before failed, so every result gets logged.
+	bool matched = BenchmarkPicks(rng, "Objects");
+	MakeSyntheticTemplates(rng, shapeCount);
+	matched = BenchmarkPicks(rng, "Objects and chunk templates") && matched;
+
+	g_ObjectList.Clear();
+	return matched && g_chunkObjectMap.GetObjectCount() == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//  Depth sort
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsFarthestFirst(const vector<ObjectHandle>& handles)
+{
+	for (size_t i = 1; i < handles.size(); ++i)
+	{
+		if (g_ObjectList.GetRecord(handles[i - 1])->m_distanceFromCamera < g_ObjectList.GetRecord(handles[i])->m_distanceFromCamera)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool RunDepthSortBenchmark()
+{
+	const int counts[] = { 100, 1000, 10000, 100000 };
+
+	mt19937 rng(2323);
+	bool sorted = true;
+
+	Log("Depth sort benchmark, microseconds per sort:");
+	Log("  objects   std::sort   radix   coherent (camera panned a tenth of a tile)");
+	for (int count : counts)
+	{
+		g_ObjectList.Clear();
+		//  Spread out around the camera target the way the visible objects are.
+		Vector3 camera{ 30, 40, 30 };
+		vector<ObjectHandle> handles;
+		for (int i = 0; i < count; ++i)
+		{
+			handles.push_back(g_ObjectList.Allocate());
+			ObjectRecord* record = g_ObjectList.GetRecord(handles.back());
+			record->m_pos = Vector3{ uniform_real_distribution<float>(-72, 72)(rng), float(i % 5), uniform_real_distribution<float>(-72, 72)(rng) };
+			record->m_distanceFromCamera = Vector3Distance(record->m_pos, camera) - record->m_pos.y;
+		}
+		shuffle(handles.begin(), handles.end(), rng);
+
+		const int passes = max(5, 2000000 / count);
+		vector<ObjectHandle> work;
+		vector<DepthSortEntry> entries;
+		vector<DepthSortEntry> scratch;
+
+		//  What MainState did before: compare through the store.
+		double stdTime = 0;
+		for (int pass = 0; pass < passes; ++pass)
+		{
+			work = handles;
+			double start = Now();
+			sort(work.begin(), work.end(),
+				[](ObjectHandle a, ObjectHandle b) { return g_ObjectList.GetRecord(a)->m_distanceFromCamera > g_ObjectList.GetRecord(b)->m_distanceFromCamera; });
+			stdTime += Now() - start;
+		}
+		sorted = sorted && IsFarthestFirst(work);
+
+		//  From scratch, keys and all.
+		double radixTime = 0;
+		for (int pass = 0; pass < passes; ++pass)
+		{
+			work = handles;
+			double start = Now();
+			entries.resize(work.size());
+			for (size_t i = 0; i < work.size(); ++i)
+			{
+				entries[i] = { DepthSortKey(g_ObjectList.GetRecord(work[i])->m_distanceFromCamera), work[i] };
+			}
+			RadixSortByKey(entries, scratch);
+			for (size_t i = 0; i < work.size(); ++i)
+			{
+				work[i] = entries[i].m_handle;
+			}
+			radixTime += Now() - start;
+		}
+		sorted = sorted && IsFarthestFirst(work);
+
+		//  Last frame's order, after the camera pans a tenth of a tile.
+		DepthSorter sorter;
+		double coherentTime = 0;
+		int radixFallbacks = 0;
+		for (int pass = 0; pass < passes; ++pass)
+		{
+			camera = Vector3Add(camera, Vector3{ .1f, 0, .05f });
+			for (ObjectHandle handle : work)
+			{
+				ObjectRecord* record = g_ObjectList.GetRecord(handle);
+				record->m_distanceFromCamera = Vector3Distance(record->m_pos, camera) - record->m_pos.y;
+			}
+
+			double start = Now();
+			entries.resize(work.size());
+			for (size_t i = 0; i < work.size(); ++i)
+			{
+				entries[i] = { DepthSortKey(g_ObjectList.GetRecord(work[i])->m_distanceFromCamera), work[i] };
+			}
+			sorter.Sort(entries);
+			for (size_t i = 0; i < work.size(); ++i)
+			{
+				work[i] = entries[i].m_handle;
+			}
+			coherentTime += Now() - start;
+
+			radixFallbacks += sorter.GetUsedRadix() ? 1 : 0;
+			sorted = sorted && IsFarthestFirst(work);
+		}
+
+		char line[256];
+		snprintf(line, sizeof(line), "  %7d   %9.1f   %5.1f   %8.1f", count, stdTime / passes * 1000000, radixTime / passes * 1000000, coherentTime / passes * 1000000);
+		Log(string(line) + (radixFallbacks > 0 ? " (" + to_string(radixFallbacks) + " of " + to_string(passes) + " fell back to radix)" : ""));
+	}
+
+	g_ObjectList.Clear();
+
+	Log(string("  Every sort came out farthest first: ") + (sorted ? "yes" : "NO"), sorted ? LOG_INFO : LOG_ERROR);
+	return sorted;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//  Loader
+////////////////////////////////////////////////////////////////////////////////
+
+struct LoadStageResult
+{
+	string m_name;
+	double m_seconds;
+	unsigned long long m_bytesRead;
+	size_t m_objectsCreated;
+	unsigned long long m_peakResidentBytes;
+};
+
+static unsigned long long FileBytes(const vector<string>& filenames)
+{
+	unsigned long long bytes = 0;
+	for (auto& filename : filenames)
+	{
+		ifstream file(filename, ios::binary | ios::ate);
+		if (file.is_open())
+		{
+			bytes += (unsigned long long)file.tellg();
+		}
+	}
+	return bytes;
+}
+
+bool RunLoadBenchmark(const string& jsonFilename)
+{
+	Config config;
+	if (!config.Load("Data/engine.cfg"))
+	{
+		Log("Could not read Data/engine.cfg; run this from the folder with Data in it.", LOG_ERROR);
+		return false;
+	}
+	string dataPath = config.GetString("data_path");
+
+	//  Just enough of the engine for the loaders.  No window, so no GL.
+	if (!g_ThreadPool)
+	{
+		g_ThreadPool = make_unique<ThreadPool>();
+		g_ThreadPool->Init((unsigned int)config.GetNumber("worker_threads"));
+	}
+	if (!g_ResourceManager)
+	{
+		g_ResourceManager = make_unique<ResourceManager>();
+	}
+	if (!g_Terrain)
+	{
+		g_Terrain = make_unique<Terrain>();
+	}
+
+	//  Never Init()ed, since that makes meshes; the loaders themselves only touch memory.
+	LoadingState loader;
+	loader.m_dataPath = dataPath;
+	loader.m_useAssetCache = false;
+	loader.m_chunkTemplates = config.GetNumber("chunk_templates") != 0;
+
+	auto superchunkFiles = [&dataPath](const string& folder, const string& prefix)
+	{
+		vector<string> filenames;
+		for (int i = 0; i < 144; ++i)
+		{
+			filenames.push_back(LoadingState::SuperchunkFilename(dataPath + folder, prefix, i));
+		}
+		return filenames;
+	};
+
+	struct LoadStage
+	{
+		string m_name;
+		vector<string> m_files;
+		function<void()> m_work;
+	};
+
+	//  Same order the objects get created in when loading for real.
+	vector<LoadStage> stages = {
+		{ "chunks", { dataPath + "/STATIC/U7CHUNKS" }, [&]() { loader.LoadChunks(); } },
+		{ "map", { dataPath + "/STATIC/U7MAP" }, [&]() { loader.LoadMap(); } },
+		{ "objecttable", { dataPath + "/STATIC/TFA.DAT", dataPath + "/STATIC/WGTVOL.DAT", dataPath + "/STATIC/TEXT.FLX" }, [&]() { loader.CreateObjectTable(); } },
+		{ "shapes", { dataPath + "/STATIC/PALETTES.FLX", dataPath + "/STATIC/SHAPES.VGA" }, [&]() { loader.DecodeShapes(); } },
+		{ "makemap", {}, [&]() { loader.MakeMap(); } },
+		{ "ifix", superchunkFiles("/STATIC/", "U7IFIX"), [&]() { loader.ParseIFIX(); loader.LoadIFIX(); } },
+		{ "ireg", superchunkFiles("/GAMEDAT/", "U7IREG"), [&]() { loader.ParseIREGFiles(); loader.LoadIREG(); } },
+		{ "initgame", { dataPath + "/STATIC/INITGAME.DAT" }, [&]() { loader.LoadInitialGameState(); } },
+	};
+
+	vector<LoadStageResult> results;
+	double totalStart = Now();
+	for (auto& stage : stages)
+	{
+		size_t objectsBefore = g_ObjectList.size();
+		double start = Now();
+		stage.m_work();
+		double seconds = Now() - start;
+
+		if (loader.m_loadingFailed)
+		{
+			Log("Loading failed during " + stage.m_name + ".", LOG_ERROR);
+			return false;
+		}
+
+		results.push_back({ stage.m_name, seconds, FileBytes(stage.m_files), g_ObjectList.size() - objectsBefore, GetPeakResidentBytes() });
+	}
+	double totalSeconds = Now() - totalStart;
+
+	unsigned long long totalBytes = 0;
+	size_t totalObjects = 0;
+	Log("Load benchmark (" + to_string(g_ThreadPool->GetNumThreads() + 1) + " threads):");
+	for (auto& result : results)
+	{
+		Log("  " + result.m_name + ": " + to_string(result.m_seconds) + "s, " + to_string(result.m_bytesRead) + " bytes, " +
+			to_string(result.m_objectsCreated) + " objects, peak RSS " + to_string(result.m_peakResidentBytes / (1024 * 1024)) + " MB");
+		totalBytes += result.m_bytesRead;
+		totalObjects += result.m_objectsCreated;
+	}
+	Log("  total: " + to_string(totalSeconds) + "s, " + to_string(totalBytes) + " bytes, " + to_string(totalObjects) + " objects");
+	for (auto& line : g_ObjectList.GetStatsText())
+	{
+		Log("  " + line);
+	}
+
+	stringstream json;
+	json << "{\n";
+	json << "  \"benchmark\": \"load\",\n";
+	json << "  \"threads\": " << g_ThreadPool->GetNumThreads() + 1 << ",\n";
+	json << "  \"stages\": [\n";
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const LoadStageResult& result = results[i];
+		json << "    { \"name\": \"" << result.m_name << "\", \"seconds\": " << result.m_seconds << ", \"bytes_read\": " << result.m_bytesRead
+			<< ", \"objects_created\": " << result.m_objectsCreated << ", \"peak_rss_bytes\": " << result.m_peakResidentBytes << " }"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	json << "  ],\n";
+	json << "  \"total_seconds\": " << totalSeconds << ",\n";
+	json << "  \"total_bytes_read\": " << totalBytes << ",\n";
+	json << "  \"total_objects\": " << totalObjects << ",\n";
+	json << "  \"peak_rss_bytes\": " << GetPeakResidentBytes() << "\n";
+	json << "}\n";
+
+	if (jsonFilename.empty())
+	{
+		printf("%s", json.str().c_str());
+	}
+	else
+	{
+		ofstream file(jsonFilename, ios::trunc);
+		file << json.str();
+		if (!file.good())
+		{
+			Log("Could not write " + jsonFilename, LOG_ERROR);
+			return false;
+		}
+	}
+
+	return true;
+}
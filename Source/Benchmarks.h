@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     BENCHMARKS.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Small self-contained benchmarks for the hot paths in the
+//           loader and renderer.  They run on synthetic data, so they
+//           don't need the Ultima VII files or a window.  Run one with
+//
+//               u7revisited -bench <name> [-json <file>]
+//
+//           and the results go to the log.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _BENCHMARKS_H_
+#define _BENCHMARKS_H_
+
+#include <string>
+
+//  Returns the process exit code: 0 if it ran and any checks it makes passed,
+//  1 if a check failed, -1 if there's no benchmark with that name.  Benchmarks
+//  with results worth comparing between runs also write them to jsonFilename,
+//  or to stdout if it's empty.
+int RunBenchmark(const std::string& name, const std::string& jsonFilename = "");
+
+//  Shape frame decoding: the old ImageDrawPixel() path against ShapeDecoder.
+void RunShapeDecodeBenchmark();
+
+//  Packs synthetic shape frames into a ShapeAtlas, reports how full the pages
+//  are, and checks every frame's pixels made it onto its page.  Returns false
+//  if any didn't.
+bool RunShapeAtlasBenchmark();
+
+//  IREG parsing, serial against the thread pool.  Also checks that objects end
+//  up in the same containers, with the same IDs, as the old inline loader.
+//  Returns false if they don't.
+bool RunIREGBenchmark();
+
+//  Range, rectangle and ray queries on g_chunkObjectMap, and building the
+//  visible object list from it and keeping it up to date, against looking at
+//  every object, with a few hundred thousand synthetic objects.  Also reports
+//  how many terrain chunks and objects the camera frustum culls at each zoom.
+//  Checks they all find the same objects, including after some are moved and
+//  deleted.  Returns false if they don't.
+bool RunSpatialBenchmark();
+
+//  Picking under the mouse with ObjectPicker, against the old way of going
+//  through the visible list, with synthetic objects and chunk templates.
+//  Checks the hits and the nearest hit against testing everything.  Returns
+//  false if they don't match.
+bool RunPickingBenchmark();
+
+//  Sorting visible objects farthest first, from 100 to 100000 of them:
+//  std::sort through the object store, against DepthSort's radix sort from
+//  scratch and its insertion sort on last frame's order.  Returns false if any
+//  sort came out wrong.
+bool RunDepthSortBenchmark();
+
+//  The CPU side of every loader (chunks, map, object table, shape decoding,
+//  IFIX, IREG, INITGAME) against the real Ultima VII files, with no window or
+//  GL context.  Reports each stage's wall time, bytes read, objects created and
+//  the peak RSS so far.  Run it from the folder with Data in it.  This is the
+//  only benchmark that needs the game files.
+bool RunLoadBenchmark(const std::string& jsonFilename);
+
+#endif
@@ -0,0 +1,124 @@
+#include "CameraFrustum.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+void CameraFrustum::Set(const Camera& camera, float aspect, float margin)
+{
+	//  The same axes MatrixLookAt() makes, and the same box rlOrtho() gets.
+	m_eye = camera.position;
+	m_forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+	m_right = Vector3Normalize(Vector3CrossProduct(m_forward, camera.up));
+	m_up = Vector3CrossProduct(m_right, m_forward);
+
+	m_halfHeight = camera.fovy / 2 + margin;
+	m_halfWidth = camera.fovy / 2 * aspect + margin;
+	m_near = float(RL_CULL_DISTANCE_NEAR);
+	m_far = float(RL_CULL_DISTANCE_FAR);
+}
+
+void CameraFrustum::Project(const BoundingBox& box, Vector3 axis, float& middle, float& radius) const
+{
+	Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), .5f);
+	Vector3 extent = Vector3Scale(Vector3Subtract(box.max, box.min), .5f);
+	middle = Vector3DotProduct(axis, Vector3Subtract(center, m_eye));
+	radius = fabsf(axis.x) * extent.x + fabsf(axis.y) * extent.y + fabsf(axis.z) * extent.z;
+}
+
+bool CameraFrustum::IsBoxVisible(const BoundingBox& box) const
+{
+	float middle;
+	float radius;
+
+	Project(box, m_right, middle, radius);
+	if (middle + radius < -m_halfWidth || middle - radius > m_halfWidth)
+	{
+		return false;
+	}
+
+	Project(box, m_up, middle, radius);
+	if (middle + radius < -m_halfHeight || middle - radius > m_halfHeight)
+	{
+		return false;
+	}
+
+	Project(box, m_forward, middle, radius);
+	return middle + radius >= m_near && middle - radius <= m_far;
+}
+
+bool CameraFrustum::IsBoxInside(const BoundingBox& box) const
+{
+	float middle;
+	float radius;
+
+	Project(box, m_right, middle, radius);
+	if (middle - radius < -m_halfWidth || middle + radius > m_halfWidth)
+	{
+		return false;
+	}
+
+	Project(box, m_up, middle, radius);
+	if (middle - radius < -m_halfHeight || middle + radius > m_halfHeight)
+	{
+		return false;
+	}
+
+	Project(box, m_forward, middle, radius);
+	return middle - radius >= m_near && middle + radius <= m_far;
+}
+
+void CameraFrustum::GetFootprint(float y, Vector2 corners[4]) const
+{
+	const float sides[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+	for (int i = 0; i < 4; ++i)
+	{
+		Vector3 corner = Vector3Add(m_eye, Vector3Add(Vector3Scale(m_right, sides[i][0] * m_halfWidth), Vector3Scale(m_up, sides[i][1] * m_halfHeight)));
+		float along = (m_forward.y != 0) ? (y - corner.y) / m_forward.y : 0;
+		corners[i] = Vector2{ corner.x + m_forward.x * along, corner.z + m_forward.z * along };
+	}
+}
+
+Rectangle CameraFrustum::GetFootprintBounds(float lowY, float highY) const
+{
+	//  Looking straight along the ground, everything in front is in view.
+	if (m_forward.y == 0)
+	{
+		return Rectangle{ -FLT_MAX / 4, -FLT_MAX / 4, FLT_MAX / 2, FLT_MAX / 2 };
+	}
+
+	//  Each footprint is the one at the ground slid along, so the ones in
+	//  between fall inside the bounds of the top and bottom ones.
+	Vector2 corners[8];
+	GetFootprint(lowY, corners);
+	GetFootprint(highY, corners + 4);
+
+	float left = corners[0].x;
+	float right = corners[0].x;
+	float top = corners[0].y;
+	float bottom = corners[0].y;
+	for (int i = 1; i < 8; ++i)
+	{
+		left = min(left, corners[i].x);
+		right = max(right, corners[i].x);
+		top = min(top, corners[i].y);
+		bottom = max(bottom, corners[i].y);
+	}
+
+	return Rectangle{ left, top, right - left, bottom - top };
+}
+
+static bool IsSame(Vector3 a, Vector3 b)
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+bool CameraFrustum::operator==(const CameraFrustum& other) const
+{
+	//  Exactly the same, not nearly; a camera creeping along still has to count.
+	return IsSame(m_eye, other.m_eye) && IsSame(m_forward, other.m_forward) && IsSame(m_right, other.m_right)
+		&& m_halfWidth == other.m_halfWidth && m_halfHeight == other.m_halfHeight;
+}
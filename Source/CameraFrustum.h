@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     CAMERAFRUSTUM.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  What an orthographic camera can see, set up the same way
+//           raylib's BeginMode3D() does it.  The view is a long box
+//           pointing down at the ground at an angle, so where it meets
+//           the ground is a parallelogram that turns with the camera,
+//           and sits further back the higher up it's taken.
+//
+//           Bounding boxes are tested against the sides of the view box
+//           directly, so a chunk or object is only culled if no part of
+//           it can be on screen.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _CAMERAFRUSTUM_H_
+#define _CAMERAFRUSTUM_H_
+
+#include "raylib.h"
+
+class CameraFrustum
+{
+public:
+	//  aspect is the width of the screen over its height.  margin widens the
+	//  view on every side, in tiles, for things drawn a little bigger than
+	//  their bounding boxes.
+	void Set(const Camera& camera, float aspect, float margin = 0);
+
+	//  Whether any of the box could be on screen.
+	bool IsBoxVisible(const BoundingBox& box) const;
+
+	//  Whether all of it is.
+	bool IsBoxInside(const BoundingBox& box) const;
+
+	//  Where the screen's corners land at height y, in x and z.  Goes around the
+	//  screen in order.
+	void GetFootprint(float y, Vector2 corners[4]) const;
+
+	//  The x, z rectangle around the footprints at every height from lowY to
+	//  highY: everywhere something that tall could be seen.
+	Rectangle GetFootprintBounds(float lowY, float highY) const;
+
+	bool operator==(const CameraFrustum& other) const;
+	bool operator!=(const CameraFrustum& other) const { return !(*this == other); }
+
+private:
+	//  How far along each of the view's axes the box reaches either side of its
+	//  middle, and where its middle is.
+	void Project(const BoundingBox& box, Vector3 axis, float& middle, float& radius) const;
+
+	Vector3 m_eye{ 0, 0, 0 };
+	Vector3 m_forward{ 0, 0, -1 };
+	Vector3 m_right{ 1, 0, 0 };
+	Vector3 m_up{ 0, 1, 0 };
+	float m_halfWidth = 0;
+	float m_halfHeight = 0;
+	float m_near = 0;
+	float m_far = 0;
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include "ChunkObjectMap.h"
+#include "U7Globals.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+ChunkObjectMap::ChunkObjectMap()
+{
+	m_chunks.resize(MAP_CHUNKS * MAP_CHUNKS);
+	m_visited.assign(MAP_CHUNKS * MAP_CHUNKS, 0);
+	m_chunkChanged.assign(MAP_CHUNKS * MAP_CHUNKS, 0);
+}
+
+int ChunkObjectMap::ChunkOf(float position)
+{
+	//  Anything off the edge of the world is filed under the edge chunk.
+	return min(max(int(floorf(position)) / CHUNK_SIZE, 0), MAP_CHUNKS - 1);
+}
+
+void ChunkObjectMap::Update(ObjectHandle handle, ObjectRecord& record, Vector3 oldPos)
+{
+	int chunkx = ChunkOf(record.m_pos.x);
+	int chunkz = ChunkOf(record.m_pos.z);
+	m_chunkChanged[chunkz * MAP_CHUNKS + chunkx] = ++m_version;
+
+	if (record.GetFlag(ObjectRecord::IN_CHUNK_MAP))
+	{
+		int oldChunkx = ChunkOf(oldPos.x);
+		int oldChunkz = ChunkOf(oldPos.z);
+		if (oldChunkx != chunkx || oldChunkz != chunkz)
+		{
+			m_chunkChanged[oldChunkz * MAP_CHUNKS + oldChunkx] = m_version;
+			vector<ObjectHandle>& oldChunk = m_chunks[oldChunkz * MAP_CHUNKS + oldChunkx];
+			auto entry = find(oldChunk.begin(), oldChunk.end(), handle);
+			if (entry != oldChunk.end())
+			{
+				*entry = oldChunk.back();
+				oldChunk.pop_back();
+			}
+			m_chunks[chunkz * MAP_CHUNKS + chunkx].push_back(handle);
+		}
+	}
+	else
+	{
+		m_chunks[chunkz * MAP_CHUNKS + chunkx].push_back(handle);
+		record.SetFlag(ObjectRecord::IN_CHUNK_MAP, true);
+		++m_count;
+	}
+
+	const BoundingBox& box = record.m_boundingBox;
+	m_maxReach = max(m_maxReach, max(max(record.m_pos.x - box.min.x, box.max.x - record.m_pos.x), max(record.m_pos.z - box.min.z, box.max.z - record.m_pos.z)));
+	m_maxTop = max(m_maxTop, box.max.y);
+}
+
+void ChunkObjectMap::Remove(ObjectHandle handle, ObjectRecord& record)
+{
+	if (!record.GetFlag(ObjectRecord::IN_CHUNK_MAP))
+	{
+		return;
+	}
+
+	int chunk = ChunkOf(record.m_pos.z) * MAP_CHUNKS + ChunkOf(record.m_pos.x);
+	m_chunkChanged[chunk] = ++m_version;
+
+	vector<ObjectHandle>& objects = m_chunks[chunk];
+	auto entry = find(objects.begin(), objects.end(), handle);
+	if (entry != objects.end())
+	{
+		*entry = objects.back();
+		objects.pop_back();
+	}
+
+	record.SetFlag(ObjectRecord::IN_CHUNK_MAP, false);
+	--m_count;
+}
+
+void ChunkObjectMap::Clear()
+{
+	for (auto& chunk : m_chunks)
+	{
+		chunk.clear();
+	}
+	m_count = 0;
+	m_maxReach = 0;
+	m_maxTop = 0;
+
+	++m_version;
+	fill(m_chunkChanged.begin(), m_chunkChanged.end(), m_version);
+}
+
+void ChunkObjectMap::GetObjectsInRect(float left, float top, float right, float bottom, vector<ObjectHandle>& out) const
+{
+	int firstChunkx = ChunkOf(left);
+	int firstChunkz = ChunkOf(top);
+	int lastChunkx = ChunkOf(right);
+	int lastChunkz = ChunkOf(bottom);
+
+	for (int chunkz = firstChunkz; chunkz <= lastChunkz; ++chunkz)
+	{
+		for (int chunkx = firstChunkx; chunkx <= lastChunkx; ++chunkx)
+		{
+			for (ObjectHandle handle : m_chunks[chunkz * MAP_CHUNKS + chunkx])
+			{
+				const Vector3& pos = g_ObjectList.GetRecord(handle)->m_pos;
+				if (pos.x >= left && pos.x <= right && pos.z >= top && pos.z <= bottom)
+				{
+					out.push_back(handle);
+				}
+			}
+		}
+	}
+}
+
+void ChunkObjectMap::GetObjectsInRange(float x, float z, float range, vector<ObjectHandle>& out) const
+{
+	int firstChunkx = ChunkOf(x - range);
+	int firstChunkz = ChunkOf(z - range);
+	int lastChunkx = ChunkOf(x + range);
+	int lastChunkz = ChunkOf(z + range);
+
+	for (int chunkz = firstChunkz; chunkz <= lastChunkz; ++chunkz)
+	{
+		for (int chunkx = firstChunkx; chunkx <= lastChunkx; ++chunkx)
+		{
+			for (ObjectHandle handle : m_chunks[chunkz * MAP_CHUNKS + chunkx])
+			{
+				const Vector3& pos = g_ObjectList.GetRecord(handle)->m_pos;
+				if (IsDistanceLessThan(x, z, pos.x, pos.z, range))
+				{
+					out.push_back(handle);
+				}
+			}
+		}
+	}
+}
+
+void ChunkObjectMap::ForEachChunkAlongRay(const Ray& ray, int margin, float top, const function<bool(int chunkx, int chunkz)>& visit) const
+{
+	//  Only the part of the ray between the ground and the top of the tallest
+	//  box can hit anything.
+	const float worldSize = float(MAP_CHUNKS * CHUNK_SIZE);
+	float start = 0;
+	float end = worldSize * 4;
+	if (ray.direction.y != 0)
+	{
+		float toGround = -ray.position.y / ray.direction.y;
+		float toTop = (top - ray.position.y) / ray.direction.y;
+		start = max(min(toGround, toTop), 0.0f);
+		end = max(toGround, toTop);
+	}
+	else if (ray.position.y < 0 || ray.position.y > top)
+	{
+		return;
+	}
+
+	if (end < start)
+	{
+		return;
+	}
+
+	float startx = ray.position.x + ray.direction.x * start;
+	float startz = ray.position.z + ray.direction.z * start;
+	float dx = ray.direction.x * (end - start);
+	float dz = ray.direction.z * (end - start);
+
+	//  Walk the chunks under that stretch of the ray one at a time, in order.
+	int chunkx = int(floorf(startx / CHUNK_SIZE));
+	int chunkz = int(floorf(startz / CHUNK_SIZE));
+	int endChunkx = int(floorf((startx + dx) / CHUNK_SIZE));
+	int endChunkz = int(floorf((startz + dz) / CHUNK_SIZE));
+
+	int stepx = dx > 0 ? 1 : -1;
+	int stepz = dz > 0 ? 1 : -1;
+	float nextx = dx != 0 ? ((chunkx + (stepx > 0 ? 1 : 0)) * CHUNK_SIZE - startx) / dx : INFINITY;
+	float nextz = dz != 0 ? ((chunkz + (stepz > 0 ? 1 : 0)) * CHUNK_SIZE - startz) / dz : INFINITY;
+	float deltax = dx != 0 ? CHUNK_SIZE / fabsf(dx) : INFINITY;
+	float deltaz = dz != 0 ? CHUNK_SIZE / fabsf(dz) : INFINITY;
+
+	++m_visitStamp;
+	if (m_visitStamp == 0)
+	{
+		fill(m_visited.begin(), m_visited.end(), 0);
+		m_visitStamp = 1;
+	}
+
+	for (int steps = 0; steps < MAP_CHUNKS * 4; ++steps)
+	{
+		for (int z = chunkz - margin; z <= chunkz + margin; ++z)
+		{
+			for (int x = chunkx - margin; x <= chunkx + margin; ++x)
+			{
+				if (x < 0 || z < 0 || x >= MAP_CHUNKS || z >= MAP_CHUNKS || m_visited[z * MAP_CHUNKS + x] == m_visitStamp)
+				{
+					continue;
+				}
+
+				m_visited[z * MAP_CHUNKS + x] = m_visitStamp;
+				if (!visit(x, z))
+				{
+					return;
+				}
+			}
+		}
+
+		if (chunkx == endChunkx && chunkz == endChunkz)
+		{
+			break;
+		}
+
+		if (nextx < nextz)
+		{
+			chunkx += stepx;
+			nextx += deltax;
+		}
+		else
+		{
+			chunkz += stepz;
+			nextz += deltaz;
+		}
+
+		//  Past the end of the world in the direction it's going.
+		if ((stepx > 0 && chunkx - margin >= MAP_CHUNKS) || (stepx < 0 && chunkx + margin < 0)
+			|| (stepz > 0 && chunkz - margin >= MAP_CHUNKS) || (stepz < 0 && chunkz + margin < 0))
+		{
+			break;
+		}
+	}
+}
+
+void ChunkObjectMap::GetObjectsAlongRay(const Ray& ray, vector<RayHit>& out) const
+{
+	ForEachChunkAlongRay(ray, [this, &ray, &out](int chunkx, int chunkz)
+		{
+			for (ObjectHandle handle : m_chunks[chunkz * MAP_CHUNKS + chunkx])
+			{
+				RayCollision collision = GetRayCollisionBox(ray, g_ObjectList.GetRecord(handle)->m_boundingBox);
+				if (collision.hit)
+				{
+					out.push_back({ handle, collision.distance });
+				}
+			}
+			return true;
+		});
+
+	sort(out.begin(), out.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
+}
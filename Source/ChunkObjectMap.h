@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     CHUNKOBJECTMAP.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Which objects are in each of the 192x192 map chunks, kept up
+//           to date as objects are created, moved and deleted, so asking
+//           what's near a point only has to look at the chunks around it
+//           instead of every object in the world.
+//
+//           An object is filed under the chunk its position is in, but
+//           its bounding box can hang over into the chunks around it, and
+//           a ray going down through a tall object can pass over other
+//           chunks first.  The map keeps track of the furthest any box
+//           reaches from its object and the highest any box goes, and the
+//           box and ray queries widen their search to match.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _CHUNKOBJECTMAP_H_
+#define _CHUNKOBJECTMAP_H_
+
+#include "raylib.h"
+#include "ObjectStore.h"
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class ChunkObjectMap
+{
+public:
+	static const int MAP_CHUNKS = 192;
+	static const int CHUNK_SIZE = 16;
+
+	ChunkObjectMap();
+
+	//  Call after changing a record's position and bounding box.  oldPos is
+	//  where it was; if the record isn't in the map yet, it's added.
+	void Update(ObjectHandle handle, ObjectRecord& record, Vector3 oldPos);
+
+	//  Takes the object back out, if it's in.
+	void Remove(ObjectHandle handle, ObjectRecord& record);
+
+	void Clear();
+
+	const std::vector<ObjectHandle>& GetChunk(int chunkx, int chunkz) const { return m_chunks[chunkz * MAP_CHUNKS + chunkx]; }
+
+	//  Objects whose positions are inside the rectangle, in tiles, edges included.
+	void GetObjectsInRect(float left, float top, float right, float bottom, std::vector<ObjectHandle>& out) const;
+
+	//  Objects whose positions are within range of x, z on the ground, like
+	//  IsDistanceLessThan().
+	void GetObjectsInRange(float x, float z, float range, std::vector<ObjectHandle>& out) const;
+
+	struct RayHit
+	{
+		ObjectHandle m_handle;
+		float m_distance;
+	};
+
+	//  Objects whose bounding boxes the ray goes through, nearest first.
+	void GetObjectsAlongRay(const Ray& ray, std::vector<RayHit>& out) const;
+
+	//  Calls visit for each chunk that could hold an object whose box the ray
+	//  goes through, roughly nearest first and each chunk once, until visit
+	//  returns false.
+	void ForEachChunkAlongRay(const Ray& ray, const std::function<bool(int chunkx, int chunkz)>& visit) const
+	{
+		ForEachChunkAlongRay(ray, GetChunkMargin(), m_maxTop, visit);
+	}
+
+	//  The same, for things that aren't in the map: margin is how many chunks
+	//  out their boxes can reach, and top how high they go.
+	void ForEachChunkAlongRay(const Ray& ray, int margin, float top, const std::function<bool(int chunkx, int chunkz)>& visit) const;
+
+	//  How many chunks out from its own an object's box can reach.
+	int GetChunkMargin() const { return int(ceilf(m_maxReach / CHUNK_SIZE)); }
+
+	//  The top of the tallest box.
+	float GetMaxTop() const { return m_maxTop; }
+
+	size_t GetObjectCount() const { return m_count; }
+
+	//  Goes up every time an object is added, moved or taken out, so anything
+	//  that keeps its own idea of what's where can tell whether it's out of date,
+	//  and which chunks changed.
+	uint32_t GetVersion() const { return m_version; }
+	bool ChunkChangedSince(int chunkx, int chunkz, uint32_t version) const { return m_chunkChanged[chunkz * MAP_CHUNKS + chunkx] > version; }
+
+	//  The chunk a position is in, along one axis, kept on the map.
+	static int ChunkOf(float position);
+
+private:
+	std::vector<std::vector<ObjectHandle> > m_chunks;
+	size_t m_count = 0;
+
+	uint32_t m_version = 0;
+	std::vector<uint32_t> m_chunkChanged; //  The version each chunk last changed in
+
+	float m_maxReach = 0;
+	float m_maxTop = 0;
+
+	//  So ForEachChunkAlongRay() doesn't visit a chunk twice.
+	mutable std::vector<unsigned int> m_visited;
+	mutable unsigned int m_visitStamp = 0;
+};
+
+#endif
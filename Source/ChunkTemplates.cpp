@@ -0,0 +1,142 @@
+#include "Geist/Globals.h"
+#include "Geist/Engine.h"
+#include "Geist/Logging.h"
+#include "U7Globals.h"
+#include "ChunkTemplates.h"
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+void ChunkTemplateInstance::Draw() const
+{
+	m_shapeData->Draw(m_pos, 0);
+
+	if (g_Engine->m_debugDrawing)
+	{
+		DrawBoundingBox(GetBoundingBox(), MAGENTA);
+	}
+}
+
+BoundingBox ChunkTemplateInstance::GetBoundingBox() const
+{
+	return GetShapeBoundingBox(m_shapeData, m_shapeData->GetDrawType(), m_pos);
+}
+
+void ChunkTemplates::Build(const WorldTiles& tiles)
+{
+	m_objects.clear();
+	m_firstObject.assign(WorldTiles::CHUNK_TYPES + 1, 0);
+	m_materialized.clear();
+
+	//  Same order AddChunkObjects() goes in.
+	for (int chunkType = 0; chunkType < WorldTiles::CHUNK_TYPES; ++chunkType)
+	{
+		m_firstObject[chunkType] = int(m_objects.size());
+
+		const uint16_t* chunkTiles = tiles.GetChunkTiles(chunkType);
+		for (int x = 0; x < 16; ++x)
+		{
+			for (int z = 0; z < 16; ++z)
+			{
+				uint16_t tile = chunkTiles[z * 16 + x];
+				if (WorldTiles::TileShape(tile) >= 150)
+				{
+					m_objects.push_back({ uint16_t(WorldTiles::TileShape(tile)), uint8_t(WorldTiles::TileFrame(tile)), uint8_t(x), uint8_t(z) });
+				}
+			}
+		}
+	}
+	m_firstObject[WorldTiles::CHUNK_TYPES] = int(m_objects.size());
+
+	m_instanceCount = 0;
+	for (int z = 0; z < WorldTiles::MAP_CHUNKS; ++z)
+	{
+		for (int x = 0; x < WorldTiles::MAP_CHUNKS; ++x)
+		{
+			m_instanceCount += GetObjectCount(tiles.GetChunkType(x, z));
+		}
+	}
+
+	m_built = true;
+
+	Log("Chunk templates: " + to_string(m_objects.size()) + " objects in " + to_string(WorldTiles::CHUNK_TYPES)
+		+ " chunk types, standing in for " + to_string(m_instanceCount) + " objects on the map.");
+}
+
+void ChunkTemplates::GetInstancesInRect(float left, float top, float right, float bottom, vector<ChunkTemplateInstance>& out) const
+{
+	if (!m_built)
+	{
+		return;
+	}
+
+	int firstChunkX = max(int(floor(left)) >> 4, 0);
+	int firstChunkZ = max(int(floor(top)) >> 4, 0);
+	int lastChunkX = min(int(floor(right)) >> 4, WorldTiles::MAP_CHUNKS - 1);
+	int lastChunkZ = min(int(floor(bottom)) >> 4, WorldTiles::MAP_CHUNKS - 1);
+
+	for (int chunkz = firstChunkZ; chunkz <= lastChunkZ; ++chunkz)
+	{
+		for (int chunkx = firstChunkX; chunkx <= lastChunkX; ++chunkx)
+		{
+			int chunkType = g_worldTiles.GetChunkType(chunkx, chunkz);
+			const ChunkTemplateObject* objects = GetObjects(chunkType);
+			int count = GetObjectCount(chunkType);
+
+			for (int i = 0; i < count; ++i)
+			{
+				int x = chunkx * 16 + objects[i].m_x;
+				int z = chunkz * 16 + objects[i].m_z;
+				if (IsMaterialized(x, z))
+				{
+					continue;
+				}
+
+				out.push_back({ &g_shapeTable[objects[i].m_shape][objects[i].m_frame], Vector3{ float(x), 0, float(z) }, 0 });
+			}
+		}
+	}
+}
+
+void ChunkTemplates::GetVisibleInstances(const Camera& camera, const CameraFrustum& frustum, vector<ChunkTemplateInstance>& out) const
+{
+	const float reach = float(MAX_REACH);
+
+	out.clear();
+	Rectangle bounds = frustum.GetFootprintBounds(0, float(MAX_HEIGHT));
+	GetInstancesInRect(bounds.x - reach, bounds.y - reach, bounds.x + bounds.width + reach, bounds.y + bounds.height + reach, out);
+
+	auto end = remove_if(out.begin(), out.end(), [&frustum](const ChunkTemplateInstance& instance)
+		{ return !frustum.IsBoxVisible(instance.GetBoundingBox()); });
+	out.erase(end, out.end());
+
+	//  Template objects all sit on the ground, so unlike the object list there's
+	//  no lift to take off the distances.
+	for (auto& instance : out)
+	{
+		instance.m_distanceFromCamera = Vector3Distance(instance.m_pos, camera.position);
+	}
+
+	sort(out.begin(), out.end(), [](const ChunkTemplateInstance& a, const ChunkTemplateInstance& b) { return a.m_distanceFromCamera > b.m_distanceFromCamera; });
+}
+
+ObjectHandle ChunkTemplates::Materialize(int x, int z)
+{
+	if (!m_built || x < 0 || z < 0 || x >= WorldTiles::WORLD_TILES || z >= WorldTiles::WORLD_TILES || IsMaterialized(x, z))
+	{
+		return ObjectStore::INVALID_HANDLE;
+	}
+
+	uint16_t tile = g_worldTiles.TileAt(x, z);
+	if (WorldTiles::TileShape(tile) < 150)
+	{
+		return ObjectStore::INVALID_HANDLE;
+	}
+
+	m_materialized.insert(z * WorldTiles::WORLD_TILES + x);
+
+	ObjectHandle id = GetNextID();
+	AddObject(WorldTiles::TileShape(tile), WorldTiles::TileFrame(tile), id, float(x), 0, float(z));
+	return id;
+}
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     CHUNKTEMPLATES.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  The objects that are part of a chunk type's tiles (anything
+//           with a shape of 150 or more: trees, rocks, fences, the odd
+//           table) kept once per chunk type instead of once per map
+//           chunk.  They're drawn and picked straight from here at their
+//           chunk's position, and only turned into real U7Objects when
+//           something needs one of its own, like being selected.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _CHUNKTEMPLATES_H_
+#define _CHUNKTEMPLATES_H_
+
+#include "raylib.h"
+#include "WorldTiles.h"
+#include "ObjectStore.h"
+#include "CameraFrustum.h"
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+class ShapeData;
+
+//  One object in a chunk type, x and z being the tile inside the chunk.
+struct ChunkTemplateObject
+{
+	uint16_t m_shape;
+	uint8_t m_frame;
+	uint8_t m_x;
+	uint8_t m_z;
+};
+
+//  A template object at its place on the map.
+struct ChunkTemplateInstance
+{
+	ShapeData* m_shapeData;
+	Vector3 m_pos;
+	double m_distanceFromCamera;
+
+	void Draw() const;
+	BoundingBox GetBoundingBox() const;
+};
+
+class ChunkTemplates
+{
+public:
+	//  No template object is taller than this, or sticks out further than this
+	//  from the tile it stands on.
+	static const int MAX_HEIGHT = 16;
+	static const int MAX_REACH = 16;
+
+	ChunkTemplates() {};
+
+	//  Collects the objects out of every chunk type.  Only reads g_worldTiles,
+	//  so it can run on a worker thread once the chunks and map are loaded.
+	void Build(const WorldTiles& tiles);
+
+	bool IsBuilt() const { return m_built; }
+
+	const ChunkTemplateObject* GetObjects(int chunkType) const { return &m_objects[m_firstObject[chunkType]]; }
+	int GetObjectCount(int chunkType) const { return m_firstObject[chunkType + 1] - m_firstObject[chunkType]; }
+
+	//  Every template object in the chunks overlapping the rectangle (in tiles)
+	//  that hasn't been made real, with m_distanceFromCamera left at 0.
+	void GetInstancesInRect(float left, float top, float right, float bottom, std::vector<ChunkTemplateInstance>& out) const;
+
+	//  The ones whose boxes are in the camera's view, sorted farthest from the
+	//  camera first.
+	void GetVisibleInstances(const Camera& camera, const CameraFrustum& frustum, std::vector<ChunkTemplateInstance>& out) const;
+
+	//  Makes a real object out of the template object on world tile x, z and
+	//  stops drawing it from the template.  Returns its ID, or INVALID_HANDLE
+	//  if there's no template object there.
+	ObjectHandle Materialize(int x, int z);
+	bool IsMaterialized(int x, int z) const { return !m_materialized.empty() && m_materialized.count(z * WorldTiles::WORLD_TILES + x) != 0; }
+
+	//  How many objects the templates stand in for across the whole map.
+	int GetInstanceCount() const { return m_instanceCount; }
+
+private:
+	std::vector<ChunkTemplateObject> m_objects;
+	std::vector<int> m_firstObject; //  Per chunk type, plus one past the end.
+	std::unordered_set<int> m_materialized; //  World tiles, z * WORLD_TILES + x.
+	int m_instanceCount = 0;
+	bool m_built = false;
+};
+
+#endif
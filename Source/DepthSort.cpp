@@ -0,0 +1,96 @@
+#include "DepthSort.h"
+#include <cstring>
+
+using namespace std;
+
+uint32_t DepthSortKey(float distance)
+{
+	//  Flipping the sign bit of a positive float, or every bit of a negative
+	//  one, gives an unsigned int in the same order as the floats.
+	uint32_t bits;
+	memcpy(&bits, &distance, sizeof(bits));
+	bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	return ~bits;
+}
+
+bool InsertionSortByKey(vector<DepthSortEntry>& entries, size_t maxMoves)
+{
+	size_t moves = 0;
+	for (size_t i = 1; i < entries.size(); ++i)
+	{
+		DepthSortEntry entry = entries[i];
+		size_t place = i;
+		while (place > 0 && entries[place - 1].m_key > entry.m_key)
+		{
+			entries[place] = entries[place - 1];
+			--place;
+		}
+		entries[place] = entry;
+
+		moves += i - place;
+		if (moves > maxMoves)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void RadixSortByKey(vector<DepthSortEntry>& entries, vector<DepthSortEntry>& scratch)
+{
+	const int RADIX_BITS = 11;
+	const int BUCKETS = 1 << RADIX_BITS;
+
+	scratch.resize(entries.size());
+	DepthSortEntry* from = entries.data();
+	DepthSortEntry* to = scratch.data();
+
+	for (int shift = 0; shift < 32; shift += RADIX_BITS)
+	{
+		size_t counts[BUCKETS] = {};
+		for (size_t i = 0; i < entries.size(); ++i)
+		{
+			++counts[(from[i].m_key >> shift) & (BUCKETS - 1)];
+		}
+
+		size_t total = 0;
+		for (int bucket = 0; bucket < BUCKETS; ++bucket)
+		{
+			size_t count = counts[bucket];
+			counts[bucket] = total;
+			total += count;
+		}
+
+		for (size_t i = 0; i < entries.size(); ++i)
+		{
+			to[counts[(from[i].m_key >> shift) & (BUCKETS - 1)]++] = from[i];
+		}
+
+		swap(from, to);
+	}
+
+	//  Three passes, so the result ended up in scratch.
+	if (from != entries.data())
+	{
+		memcpy(entries.data(), from, entries.size() * sizeof(DepthSortEntry));
+	}
+}
+
+void DepthSorter::Sort(vector<DepthSortEntry>& entries)
+{
+	//  A few moves per entry is a camera that barely moved, plus a few objects
+	//  that just came into view.  Past that the radix sort is quicker.  Once the
+	//  insertion sort has given up, it's only tried every so often until it
+	//  works again, so a list that's always far out of order doesn't pay for
+	//  both.
+	bool tryInsertion = !m_usedRadix || ++m_sortsSinceFallback >= RETRY_INSERTION;
+	m_usedRadix = !tryInsertion || !InsertionSortByKey(entries, entries.size() * 4 + 64);
+	if (m_usedRadix)
+	{
+		if (tryInsertion)
+		{
+			m_sortsSinceFallback = 0;
+		}
+		RadixSortByKey(entries, m_scratch);
+	}
+}
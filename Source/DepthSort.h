@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     DEPTHSORT.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Sorting the visible objects farthest first for drawing.  Each
+//           object is a (key, handle) pair, where the key is its distance
+//           turned into an integer that sorts the same way, so sorting
+//           never has to look the objects up.
+//
+//           From one frame to the next the camera hardly moves, so the
+//           list is nearly in order already.  An insertion sort puts it
+//           right in close to one pass; if it turns out to be too far out
+//           of order for that, a radix sort on the keys does it instead.
+//           Neither allocates once the buffers have grown to fit.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _DEPTHSORT_H_
+#define _DEPTHSORT_H_
+
+#include "ObjectStore.h"
+#include <cstdint>
+#include <vector>
+
+struct DepthSortEntry
+{
+	uint32_t m_key;
+	ObjectHandle m_handle;
+};
+
+//  The key for a distance: the farther away, the smaller the key, so sorting
+//  the keys upward gives farthest first.
+uint32_t DepthSortKey(float distance);
+
+//  Sorts by key with an insertion sort, but gives up once it's moved more than
+//  maxMoves entries, leaving them in some other order.  Returns whether it
+//  finished.
+bool InsertionSortByKey(std::vector<DepthSortEntry>& entries, size_t maxMoves);
+
+//  Sorts by key, three passes of eleven bits.  scratch is resized to fit.
+void RadixSortByKey(std::vector<DepthSortEntry>& entries, std::vector<DepthSortEntry>& scratch);
+
+class DepthSorter
+{
+public:
+	//  Insertion sort if the entries are nearly in order, radix sort if not.
+	void Sort(std::vector<DepthSortEntry>& entries);
+
+	//  How the last Sort() went.
+	bool GetUsedRadix() const { return m_usedRadix; }
+
+private:
+	static const int RETRY_INSERTION = 16;
+
+	std::vector<DepthSortEntry> m_scratch;
+	bool m_usedRadix = false;
+	int m_sortsSinceFallback = 0;
+};
+
+#endif
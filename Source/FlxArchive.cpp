@@ -0,0 +1,190 @@
+//  Deliberately does not include raylib.h; windows.h and raylib.h don't get along.
+
+#include "FlxArchive.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+//  MappedFile
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const string& filename)
+{
+	Close();
+
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || size.QuadPart > 0xFFFFFFFFLL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	m_data = (const unsigned char*)data;
+	m_size = (unsigned int)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mappingHandle);
+		CloseHandle(m_fileHandle);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const string& filename)
+{
+	Close();
+
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0 || info.st_size > 0xFFFFFFFFLL)
+	{
+		close(file);
+		return false;
+	}
+
+	void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	//  The mapping keeps its own reference to the file.
+	close(file);
+
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	m_data = (const unsigned char*)data;
+	m_size = (unsigned int)info.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		munmap((void*)m_data, m_size);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//  FlxArchive
+////////////////////////////////////////////////////////////////////////////////
+
+bool FlxArchive::Open(const string& filename)
+{
+	Close();
+
+	if (!m_file.Open(filename))
+	{
+		return false;
+	}
+
+	ByteReader reader(m_file.GetData());
+
+	//  Flex files have a header of 80 bytes, which is the same for every file:
+	//  "Ultima VII Data File (C) 1992 Origin Inc."
+	reader.Skip(80);
+
+	//  This is followed two unsigned ints.  The first unsigned int is always the same, so we can ignore it.
+	//  The second is the number of entries in the file.
+	reader.ReadU32();
+	unsigned int entrycount = reader.ReadU32();
+
+	//  Now we have ten unsigned ints worth of data that we can ignore.
+	reader.Skip(40);
+
+	if (reader.Failed() || entrycount > reader.Remaining() / 8)
+	{
+		Close();
+		return false;
+	}
+
+	//  Now we have the data we want.  Each entry is 8 bytes long.
+	m_entries.resize(entrycount);
+	for (unsigned int i = 0; i < entrycount; ++i)
+	{
+		FLXEntryData& thisentry = m_entries[i];
+		thisentry.offset = reader.ReadU32();
+		thisentry.length = reader.ReadU32();
+
+		//  Offset of 0 means no data here.  Anything running off the end of the file is treated the same way.
+		if (thisentry.offset == 0 || thisentry.offset > m_file.GetSize() || thisentry.length > m_file.GetSize() - thisentry.offset)
+		{
+			thisentry.offset = 0;
+			thisentry.length = 0;
+		}
+	}
+
+	return true;
+}
+
+void FlxArchive::Close()
+{
+	m_file.Close();
+	m_entries.clear();
+}
+
+ByteSpan FlxArchive::GetEntry(unsigned int index) const
+{
+	if (index >= m_entries.size() || m_entries[index].offset == 0)
+	{
+		return ByteSpan();
+	}
+
+	return ByteSpan{ m_file.GetData().m_data + m_entries[index].offset, m_entries[index].length };
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     FLXARCHIVE.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Read-only access to Ultima VII data files.  Most of the
+//           original files are "flex" files: an 80-byte copyright
+//           header, a count, a table of (offset, length) pairs and then
+//           the entry data.  FlxArchive memory-maps the file once and
+//           hands out ByteSpan views into the mapping, so nothing is
+//           copied and nothing goes through an istream.
+//
+//           The views are only valid while the archive they came from
+//           is open.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _FLXARCHIVE_H_
+#define _FLXARCHIVE_H_
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+//  A non-owning view of a block of bytes.
+struct ByteSpan
+{
+	const unsigned char* m_data = nullptr;
+	unsigned int m_length = 0;
+
+	bool IsEmpty() const { return m_data == nullptr || m_length == 0; }
+};
+
+//  Little-endian reader over a ByteSpan.  Reads past the end of the span
+//  return zero and set the failure flag instead of reading garbage.
+class ByteReader
+{
+public:
+	ByteReader() {};
+	ByteReader(ByteSpan span) : m_span(span) {};
+
+	unsigned char ReadU8() { unsigned char value = 0; Read(&value, sizeof(value)); return value; }
+	unsigned short ReadU16() { unsigned short value = 0; Read(&value, sizeof(value)); return value; }
+	unsigned int ReadU32() { unsigned int value = 0; Read(&value, sizeof(value)); return value; }
+	char ReadS8() { char value = 0; Read(&value, sizeof(value)); return value; }
+	short ReadS16() { short value = 0; Read(&value, sizeof(value)); return value; }
+	int ReadS32() { int value = 0; Read(&value, sizeof(value)); return value; }
+
+	void Read(void* dest, unsigned int length)
+	{
+		if (m_pos > m_span.m_length || length > m_span.m_length - m_pos)
+		{
+			m_failed = true;
+			m_pos = m_span.m_length;
+			return;
+		}
+		memcpy(dest, m_span.m_data + m_pos, length);
+		m_pos += length;
+	}
+
+	void Skip(unsigned int length) { Seek(m_pos + length); }
+	void Seek(unsigned int pos) { if (pos > m_span.m_length) { m_failed = true; pos = m_span.m_length; } m_pos = pos; }
+	unsigned int Tell() const { return m_pos; }
+	unsigned int Remaining() const { return m_span.m_length - m_pos; }
+
+	//  The bytes from the current position to the end of the span.
+	const unsigned char* Current() const { return m_span.m_data + m_pos; }
+
+	bool Eof() const { return m_pos >= m_span.m_length; }
+	bool Failed() const { return m_failed; }
+
+private:
+	ByteSpan m_span;
+	unsigned int m_pos = 0;
+	bool m_failed = false;
+};
+
+//  A whole file mapped into memory.  Not copyable; the mapping is released
+//  in Close() or the destructor.
+class MappedFile
+{
+public:
+	MappedFile() {};
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	ByteSpan GetData() const { return ByteSpan{ m_data, m_size }; }
+	unsigned int GetSize() const { return m_size; }
+
+private:
+	const unsigned char* m_data = nullptr;
+	unsigned int m_size = 0;
+
+#ifdef _WIN32
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+};
+
+class FlxArchive
+{
+public:
+	struct FLXEntryData
+	{
+		unsigned int offset;
+		unsigned int length;
+	};
+
+	FlxArchive() {};
+
+	FlxArchive(const FlxArchive&) = delete;
+	FlxArchive& operator=(const FlxArchive&) = delete;
+
+	//  Maps the file and parses the entry table.  Returns false if the file
+	//  couldn't be opened or is too small to be a flex file.
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	unsigned int GetEntryCount() const { return (unsigned int)m_entries.size(); }
+	const std::vector<FLXEntryData>& GetEntries() const { return m_entries; }
+
+	//  Returns an empty span for missing entries (offset 0) or out-of-range indices.
+	ByteSpan GetEntry(unsigned int index) const;
+
+	//  The whole file, header included.  Entry offsets are relative to this.
+	ByteSpan GetData() const { return m_file.GetData(); }
+
+private:
+	MappedFile m_file;
+	std::vector<FLXEntryData> m_entries;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "Engine.h"
 #include "ResourceManager.h"
 #include "StateMachine.h"
+#include "ThreadPool.h"
 #include "Logging.h"
 #include <sstream>
 #include <fstream>
@@ -15,6 +16,10 @@ void Engine::Init(const std::string& configfile)
 	m_ConfigFileName = configfile;
 	m_EngineConfig.Load(configfile);
 
+	//  0 (or missing) lets the pool size itself to the machine.
+	g_ThreadPool = make_unique<ThreadPool>();
+	g_ThreadPool->Init((unsigned int)m_EngineConfig.GetNumber("worker_threads"));
+
 	g_ResourceManager = make_unique<ResourceManager>();
 	g_ResourceManager->Init(configfile);
 	g_StateMachine = make_unique<StateMachine>();
@@ -48,6 +53,7 @@ void Engine::Shutdown()
 {
 	g_StateMachine->Shutdown();
 	g_ResourceManager->Shutdown();
+	g_ThreadPool->Shutdown();
 }
 
 void Engine::Update()
@@ -408,39 +408,41 @@ void SpriteSheet::DrawSprite(int spritex, int spritey, int posx, int posy)
 	temp.Draw(float(posx), float(posy));
 }
 
+//  These move raw pixels rather than going through Color, so they work on
+//  indexed (one byte per pixel) images as well as RGBA ones.
 void ModTexture::MoveImageRowLeft(int row)
 {
-	for (int x = 0; x < m_Image.width - 1; ++x)
-	{
-		Color newPixel = GetImageColor(m_Image, x + 1, row);
-		ImageDrawPixel(&m_Image, x, row, newPixel);
-	}
+	int bpp = GetPixelDataSize(1, 1, m_Image.format);
+	unsigned char* pixels = (unsigned char*)m_Image.data + row * m_Image.width * bpp;
+	memmove(pixels, pixels + bpp, (m_Image.width - 1) * bpp);
 }
 
 void ModTexture::MoveImageRowRight(int row)
 {
-	for (int x = m_Image.width - 1; x > 0; --x)
-	{
-		Color newPixel = GetImageColor(m_Image, x - 1, row);
-		ImageDrawPixel(&m_Image, x, row, newPixel);
-	}
+	int bpp = GetPixelDataSize(1, 1, m_Image.format);
+	unsigned char* pixels = (unsigned char*)m_Image.data + row * m_Image.width * bpp;
+	memmove(pixels + bpp, pixels, (m_Image.width - 1) * bpp);
 }
 
 void ModTexture::MoveImageColumnUp(int column)
 {
+	int bpp = GetPixelDataSize(1, 1, m_Image.format);
+	int stride = m_Image.width * bpp;
+	unsigned char* pixels = (unsigned char*)m_Image.data + column * bpp;
 	for (int y = 0; y < m_Image.height - 1; ++y)
 	{
-		Color newPixel = GetImageColor(m_Image, column, y + 1);
-		ImageDrawPixel(&m_Image, column, y, newPixel);
+		memcpy(pixels + y * stride, pixels + (y + 1) * stride, bpp);
 	}
 }
 
 void ModTexture::MoveImageColumnDown(int column)
 {
+	int bpp = GetPixelDataSize(1, 1, m_Image.format);
+	int stride = m_Image.width * bpp;
+	unsigned char* pixels = (unsigned char*)m_Image.data + column * bpp;
 	for (int y = m_Image.height - 1; y > 0; --y)
 	{
-		Color newPixel = GetImageColor(m_Image, column, y - 1);
-		ImageDrawPixel(&m_Image, column, y, newPixel);
+		memcpy(pixels + y * stride, pixels + (y - 1) * stride, bpp);
 	}
 }
 
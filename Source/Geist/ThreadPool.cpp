@@ -0,0 +1,171 @@
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <exception>
+
+using namespace std;
+
+void ThreadPool::Init(unsigned int numThreads)
+{
+	Shutdown();
+
+	if (numThreads == 0)
+	{
+		unsigned int hardwareThreads = thread::hardware_concurrency();
+		numThreads = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+
+	m_Stopping = false;
+	for (unsigned int i = 0; i < numThreads; ++i)
+	{
+		m_Threads.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+void ThreadPool::Shutdown()
+{
+	{
+		lock_guard<mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+
+	for (auto& worker : m_Threads)
+	{
+		worker.join();
+	}
+
+	m_Threads.clear();
+	m_Jobs.clear();
+}
+
+future<void> ThreadPool::Submit(function<void()> job)
+{
+	auto task = make_shared<packaged_task<void()> >(move(job));
+	future<void> result = task->get_future();
+
+	//  No workers (not initialized, or shutting down): just do it now.
+	if (m_Threads.empty())
+	{
+		(*task)();
+		return result;
+	}
+
+	{
+		lock_guard<mutex> lock(m_Mutex);
+		m_Jobs.emplace_back([task]() { (*task)(); });
+	}
+	m_Condition.notify_one();
+
+	return result;
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		function<void()> job;
+		{
+			unique_lock<mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+			if (m_Jobs.empty())
+			{
+				return; // Stopping and nothing left to do.
+			}
+
+			job = move(m_Jobs.front());
+			m_Jobs.pop_front();
+		}
+
+		job();
+	}
+}
+
+void ThreadPool::ParallelFor(int begin, int end, const function<void(int)>& func)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+
+	//  Shared with the helper jobs, which may not get to run until after we've
+	//  returned if the pool is busy.  They'll find nothing left and exit.
+	struct ForState
+	{
+		atomic<int> next;
+		atomic<int> remaining;
+		int end;
+		const function<void(int)>* func;
+		mutex mtx;
+		condition_variable done;
+		exception_ptr error;
+	};
+
+	auto state = make_shared<ForState>();
+	state->next = begin;
+	state->remaining = end - begin;
+	state->end = end;
+	state->func = &func;
+
+	auto work = [](shared_ptr<ForState> state)
+	{
+		while (true)
+		{
+			int i = state->next++;
+			if (i >= state->end)
+			{
+				return;
+			}
+
+			try
+			{
+				(*state->func)(i);
+			}
+			catch (...)
+			{
+				lock_guard<mutex> lock(state->mtx);
+				if (!state->error)
+				{
+					state->error = current_exception();
+				}
+			}
+
+			if (--state->remaining == 0)
+			{
+				lock_guard<mutex> lock(state->mtx);
+				state->done.notify_all();
+			}
+		}
+	};
+
+	unsigned int helpers = (unsigned int)(end - begin - 1);
+	if (helpers > m_Threads.size())
+	{
+		helpers = (unsigned int)m_Threads.size();
+	}
+
+	if (helpers > 0)
+	{
+		{
+			lock_guard<mutex> lock(m_Mutex);
+			for (unsigned int i = 0; i < helpers; ++i)
+			{
+				m_Jobs.emplace_back([state, work]() { work(state); });
+			}
+		}
+		m_Condition.notify_all();
+	}
+
+	work(state);
+
+	{
+		unique_lock<mutex> lock(state->mtx);
+		state->done.wait(lock, [&state]() { return state->remaining == 0; });
+	}
+
+	if (state->error)
+	{
+		rethrow_exception(state->error);
+	}
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     THREADPOOL.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  A fixed set of worker threads that chew through a queue of
+//           jobs.  Submit() queues a single job and hands back a future
+//           for it; ParallelFor() splits a range of indices across the
+//           workers and the calling thread and returns when every index
+//           has been processed.
+//
+//           Jobs must not touch raylib's window, input or GL state - only
+//           the main thread owns those.  Decode into CPU-side buffers on
+//           the workers and upload on the main thread.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+class ThreadPool
+{
+public:
+	ThreadPool() {};
+	~ThreadPool() { Shutdown(); }
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//  0 means one worker per hardware thread, less one for the main thread.
+	void Init(unsigned int numThreads = 0);
+	void Shutdown();
+
+	unsigned int GetNumThreads() const { return (unsigned int)m_Threads.size(); }
+
+	std::future<void> Submit(std::function<void()> job);
+
+	//  Calls func(i) for every i in [begin, end).  The calling thread helps out,
+	//  so this is safe to call from inside a job.  If any call throws, the first
+	//  exception is rethrown here once the remaining indices are done.
+	void ParallelFor(int begin, int end, const std::function<void(int)>& func);
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> m_Threads;
+	std::deque<std::function<void()> > m_Jobs;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stopping = false;
+};
+
+#endif
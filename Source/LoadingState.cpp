@@ -3,8 +3,14 @@
 #include "Geist/Logging.h"
 #include "Geist/Engine.h"
 #include "Geist/ResourceManager.h"
+#include "Geist/ThreadPool.h"
 #include "U7Globals.h"
 #include "LoadingState.h"
+#include "FlxArchive.h"
+#include "ShapeDecoder.h"
+#include "AssetCache.h"
+#include "ShapeTableFile.h"
+#include "SuperchunkStreamer.h"
 
 
 
@@ -85,6 +91,21 @@ void LoadingState::Draw()
 	else
 	{
 		DrawConsole();
+
+		//  Whatever's in progress, and how far along everything is overall.
+		float lineHeight = g_SmallFont->baseSize + 2;
+		float y = g_Engine->m_RenderHeight - lineHeight * 2;
+		std::string overall = "Loading... " + std::to_string(int(GetLoadingProgress() * 100)) + "%";
+		DrawTextEx(*g_SmallFont, overall.c_str(), Vector2{ 0, y }, g_SmallFont->baseSize, 1, WHITE);
+		for (auto& stage : m_stages)
+		{
+			if (stage.m_status == LoadingStage::RUNNING || stage.m_status == LoadingStage::MAINTHREAD)
+			{
+				y -= lineHeight;
+				std::string line = stage.m_name + "... " + std::to_string(int(stage.m_progress * 100)) + "%";
+				DrawTextEx(*g_SmallFont, line.c_str(), Vector2{ 0, y }, g_SmallFont->baseSize, 1, LIGHTGRAY);
+			}
+		}
 	}
 
 
@@ -104,139 +125,187 @@ void LoadingState::Draw()
 }
 
 
-void LoadingState::UpdateLoading()
+void LoadingState::SetStage(LoadingStageId id, const std::string& name, std::vector<int> dependencies,
+	std::function<void()> work, std::function<bool()> mainThreadWork)
 {
-	if (!m_loadingFailed)
-	{
-		if (!m_loadingVersion)
-		{
-			AddConsoleString(std::string("Loading version..."));
-			LoadVersion();
-			m_loadingVersion = true;
-			return;
-		}
+	LoadingStage& stage = m_stages[id];
+	stage.m_name = name;
+	stage.m_dependencies = dependencies;
+	stage.m_work = work;
+	stage.m_mainThreadWork = mainThreadWork;
+	stage.m_status = LoadingStage::WAITING;
+	stage.m_progress = 0;
+}
 
-		if (!m_loadingChunks)
+void LoadingState::CreateLoadingStages()
+{
+	m_dataPath = g_Engine->m_EngineConfig.GetString("data_path");
+	m_streamRadius = g_Engine->m_EngineConfig.GetNumber("stream_radius");
+	m_useShapeAtlas = g_Engine->m_EngineConfig.GetNumber("shape_atlas") != 0;
+	m_tileTerrain = g_Engine->m_EngineConfig.GetNumber("tile_terrain") != 0;
+	m_chunkTemplates = g_Engine->m_EngineConfig.GetNumber("chunk_templates") != 0;
+
+	SetStage(LOADSTAGE_VERSION, "Loading version", {}, [this]() { LoadVersion(); });
+	SetStage(LOADSTAGE_CHUNKS, "Loading chunks", {}, [this]() { LoadChunks(); });
+	SetStage(LOADSTAGE_MAP, "Loading mapfile", {}, [this]() { LoadMap(); });
+	SetStage(LOADSTAGE_OBJECTTABLE, "Loading objects", {}, [this]() { CreateObjectTable(); });
+	SetStage(LOADSTAGE_MODELS, "Loading models", {}, nullptr, [this]() { LoadModels(); return true; });
+
+	//  Decoding is all CPU work; the upload has to wait for the object table
+	//  because setting up the shapes reads it.
+	SetStage(LOADSTAGE_DECODESHAPES, "Decoding shapes", {}, [this]() { DecodeShapes(); });
+	SetStage(LOADSTAGE_SHAPETABLE, "Reading shape table", {}, [this]() { LoadShapeTable(); });
+	SetStage(LOADSTAGE_UPLOADSHAPES, "Loading shapes", { LOADSTAGE_DECODESHAPES, LOADSTAGE_OBJECTTABLE, LOADSTAGE_SHAPETABLE }, nullptr, [this]() { return UploadShapes(); });
+	SetStage(LOADSTAGE_SHAPEATLAS, "Packing shape atlas", { LOADSTAGE_UPLOADSHAPES }, [this]() { PackShapeAtlas(); }, [this]() { return UploadShapeAtlas(); });
+	SetStage(LOADSTAGE_TERRAIN, "Creating terrain", { LOADSTAGE_CHUNKS, LOADSTAGE_DECODESHAPES }, [this]() { CreateChunkTextures(); },
+		[this]()
 		{
-			AddConsoleString(std::string("Loading chunks..."));
-			LoadChunks();
-			m_loadingChunks = true;
-			return;
-		}
+			g_Terrain->Init(m_chunkCache.IsOpen() ? m_chunkCache.GetPayload().m_data : nullptr);
+			m_chunkCache.Close();
+			Log("Done creating terrain.");
+			return true;
+		});
+
+	//  The tile terrain doesn't need chunk images, just the map.
+	if (m_tileTerrain)
+	{
+		SetStage(LOADSTAGE_TERRAIN, "Creating terrain", { LOADSTAGE_CHUNKS, LOADSTAGE_MAP, LOADSTAGE_DECODESHAPES }, nullptr,
+			[this]()
+			{
+				g_Terrain->InitTiles();
+				Log("Done creating tile terrain.");
+				return true;
+			});
+	}
 
-		if (!m_loadingMap)
+	//  Files can be parsed whenever, but objects have to be created in the same
+	//  order as always or they'd get different IDs: map, IFIX, IREG, NPCs.  They
+	//  also need the shape table, since objects look up how they're drawn, and
+	//  the models, since creating objects goes through the resource manager too.
+	SetStage(LOADSTAGE_MAKEMAP, "Making map", { LOADSTAGE_CHUNKS, LOADSTAGE_MAP, LOADSTAGE_UPLOADSHAPES, LOADSTAGE_MODELS }, [this]() { MakeMap(); });
+	SetStage(LOADSTAGE_PARSEIFIX, "Reading IFIX", {}, [this]() { ParseIFIX(); });
+	SetStage(LOADSTAGE_IFIX, "Loading IFIX", { LOADSTAGE_MAKEMAP, LOADSTAGE_PARSEIFIX }, [this]() { LoadIFIX(); });
+	SetStage(LOADSTAGE_PARSEIREG, "Reading IREG", {}, [this]() { ParseIREGFiles(); });
+	SetStage(LOADSTAGE_IREG, "Loading IREG", { LOADSTAGE_IFIX, LOADSTAGE_PARSEIREG }, [this]() { LoadIREG(); });
+	SetStage(LOADSTAGE_INITIALGAMESTATE, "Loading Initial Game State", { LOADSTAGE_IREG, LOADSTAGE_OBJECTTABLE }, [this]() { LoadInitialGameState(); });
+
+	if (m_streamRadius > 0)
+	{
+		for (int id : { LOADSTAGE_PARSEIFIX, LOADSTAGE_IFIX, LOADSTAGE_PARSEIREG, LOADSTAGE_IREG })
 		{
-			AddConsoleString(std::string("Loading mapfile..."));
-			LoadMap();
-			m_loadingMap = true;
-			return;
+			m_stages[id].m_work = []() {};
 		}
+	}
 
-		if (!m_loadingObjects)
-		{
-			AddConsoleString(std::string("Loading objects..."));
-			CreateObjectTable();
-			m_loadingObjects = true;
-			return;
-		}
+	m_loadingStartTime = GetTime();
+	m_stagesCreated = true;
+}
 
-		if(!m_loadingModels)
-		{
-			AddConsoleString(std::string("Loading models..."));
-			LoadModels();
-			m_loadingModels = true;
-			return;
-		}
+float LoadingState::GetLoadingProgress()
+{
+	float progress = 0;
+	for (auto& stage : m_stages)
+	{
+		progress += (stage.m_status == LoadingStage::DONE) ? 1.0f : stage.m_progress.load();
+	}
 
-		if (!m_loadingShapes)
-		{
-			AddConsoleString(std::string("Loading shapes..."));
-			CreateShapeTable();
-			m_loadingShapes = true;
-			return;
-		}
+	return progress / m_stages.size();
+}
+
+void LoadingState::UpdateLoading()
+{
+	if (m_loadingFailed)
+	{
+		return;
+	}
 
-		if (!m_makingMap)
+	if (!m_stagesCreated)
+	{
+		CreateLoadingStages();
+	}
+
+	//  Start anything that's ready and collect anything that's finished.
+	bool allDone = true;
+	for (auto& stage : m_stages)
+	{
+		if (stage.m_status == LoadingStage::WAITING)
 		{
-			AddConsoleString(std::string("Making map..."));
-			MakeMap();
-			m_makingMap = true;
-			return;
+			bool ready = true;
+			for (int dependency : stage.m_dependencies)
+			{
+				if (m_stages[dependency].m_status != LoadingStage::DONE)
+				{
+					ready = false;
+					break;
+				}
+			}
+
+			if (ready)
+			{
+				AddConsoleString(stage.m_name + "...");
+				stage.m_startTime = GetTime();
+				if (stage.m_work)
+				{
+					stage.m_future = g_ThreadPool->Submit(stage.m_work);
+					stage.m_status = LoadingStage::RUNNING;
+				}
+				else
+				{
+					stage.m_status = LoadingStage::MAINTHREAD;
+				}
+			}
 		}
 
-		if (!m_loadingIFIX)
+		if (stage.m_status == LoadingStage::RUNNING && stage.m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
 		{
-			AddConsoleString(std::string("Loading IFIX..."));
-			LoadIFIX();
-			m_loadingIFIX = true;
-			return;
+			//  Rethrows anything the stage threw.
+			stage.m_future.get();
+			stage.m_status = stage.m_mainThreadWork ? LoadingStage::MAINTHREAD : LoadingStage::DONE;
 		}
 
-		if (!m_loadingIREG)
+		if (stage.m_status == LoadingStage::DONE && stage.m_startTime != 0)
 		{
-			AddConsoleString(std::string("Loading IREG..."));
-			LoadIREG();
-			m_loadingIREG = true;
-			return;
+			Log(stage.m_name + ": " + std::to_string(GetTime() - stage.m_startTime));
+			stage.m_startTime = 0;
 		}
 
-		if (!m_loadingInitialGameState)
+		if (stage.m_status != LoadingStage::DONE)
 		{
-			AddConsoleString(std::string("Loading Initial Game State..."));
-			LoadInitialGameState();
-			m_loadingInitialGameState = true;
-			return;
+			allDone = false;
 		}
-
 	}
-	else
+
+	if (m_loadingFailed)
 	{
 		return;
 	}
 
-	g_StateMachine->MakeStateTransition(STATE_TITLESTATE);
-}
-
-unsigned char LoadingState::ReadU8(istream &buffer)
-{
-	unsigned char thisData;
-	buffer.read((char*)&thisData, sizeof(unsigned char));
-	return thisData;
-}
-
-unsigned short LoadingState::ReadU16(istream &buffer)
-{
-	unsigned short thisData;
-	buffer.read((char*)&thisData, sizeof(unsigned short));
-	return thisData;
-}
+	//  Then give the main thread work what's left of this frame.
+	double frameEnd = GetTime() + 1.0 / 60.0;
+	for (auto& stage : m_stages)
+	{
+		while (stage.m_status == LoadingStage::MAINTHREAD && GetTime() < frameEnd)
+		{
+			if (stage.m_mainThreadWork())
+			{
+				stage.m_status = LoadingStage::DONE;
+			}
+		}
+	}
 
-unsigned int LoadingState::ReadU32(istream &buffer)
-{
-	unsigned int thisData;
-	buffer.read((char*)&thisData, sizeof(unsigned int));
-	return thisData;
-}
+	if (!allDone)
+	{
+		return;
+	}
 
-char LoadingState::ReadS8(istream &buffer)
-{
-	char thisData;
-	buffer.read((char*)&thisData, sizeof(char));
-	return thisData;
-}
+	Log("Time to load: " + std::to_string(GetTime() - m_loadingStartTime));
 
-short LoadingState::ReadS16(istream &buffer)
-{
-	short thisData;
-	buffer.read((char*)&thisData, sizeof(short));
-	return thisData;
-}
+	if (m_streamRadius > 0)
+	{
+		g_SuperchunkStreamer->Init(m_dataPath, m_streamRadius);
+	}
 
-int LoadingState::ReadS32(istream &buffer)
-{
-	int thisData;
-	buffer.read((char*)&thisData, sizeof(int));
-	return thisData;
+	g_StateMachine->MakeStateTransition(STATE_TITLESTATE);
 }
 
 void LoadingState::LoadVersion()
@@ -258,7 +327,7 @@ void LoadingState::LoadVersion()
 
 void LoadingState::LoadChunks()
 {
-	std::string dataPath = g_Engine->m_EngineConfig.GetString("data_path");
+	std::string dataPath = m_dataPath;
 	
 	//  Load data for all chunks first
 	std::string loadingPath(dataPath);
@@ -271,24 +340,18 @@ void LoadingState::LoadChunks()
 		return;
 	}
 
-	//  Each chunk should be an ID associated with 16 arrays, each 16 unsigned chars deep.
-	for (int i = 0; i < 3072; ++i)
+	//  Each chunk is 16 rows of 16 tiles.
+	for (int i = 0; i < WorldTiles::CHUNK_TYPES; ++i)
 	{
+		unsigned short chunk[256] = { 0 };
+		fread(chunk, sizeof(unsigned short), 256, u7chunksfile);
+
 		for (int j = 0; j < 16; ++j)
 		{
 			for (int k = 0; k < 16; ++k)
 			{
-				unsigned short thisdata;
-				unsigned char frontend;
-				unsigned char backend;
-				fread(&thisdata, sizeof(unsigned short), 1, u7chunksfile);
-
-				unsigned int shapenum = thisdata & 0x3ff;
-				unsigned int framenum = thisdata >> 10;
-
-				g_ChunkTypeList[i][j][k] = thisdata;
+				g_worldTiles.SetChunkTile(i, k, j, chunk[j * 16 + k]);
 			}
-			
 		}
 	}
 	fclose(u7chunksfile);
@@ -296,10 +359,16 @@ void LoadingState::LoadChunks()
 
 void LoadingState::LoadMap()
 {
-	std::string dataPath = g_Engine->m_EngineConfig.GetString("data_path");
+	std::string dataPath = m_dataPath;
 	std::string loadingPath(dataPath);
 	loadingPath.append("/STATIC/U7MAP");
 	FILE* u7mapfile = fopen(loadingPath.c_str(), "rb");
+	if (u7mapfile == nullptr)
+	{
+		Log("Ultima VII files not found.  They should go into the Data/U7 folder.");
+		m_loadingFailed = true;
+		return;
+	}
 
 	//  Untangle the map and chunk files into a single array.
 	//  Create the map of chunk ids and chunk data
@@ -318,7 +387,7 @@ void LoadingState::LoadMap()
 					unsigned short thisdata = 0;
 					fread(&thisdata, sizeof(unsigned short), 1, u7mapfile);
 
-					g_chunkTypeMap[l * 16 + i][k * 16 + j] = thisdata;
+					g_worldTiles.SetChunkType(l * 16 + i, k * 16 + j, thisdata);
 				}
 			}
 		}
@@ -326,550 +395,843 @@ void LoadingState::LoadMap()
 	fclose(u7mapfile);
 }
 
-void LoadingState::LoadIFIX()
+bool LoadingState::ParseIFIXSuperchunk(const std::string& filename, int superchunkx, int superchunky, std::vector<IFIXObject>& objects)
 {
-	std::string dataPath = g_Engine->m_EngineConfig.GetString("data_path");
-	std::string loadingPath(dataPath);
-	loadingPath.append("/STATIC/");
+	//  Even though these files don't have an .flx description,
+	//  these are flex files.
+	FlxArchive u7thisifix;
+	if (!u7thisifix.Open(filename))
+	{
+		return false;
+	}
 
-	for (int superchunky = 0; superchunky < 12; ++superchunky)
+	//  Now, having processed the header, we can process the, you know, data.
+	for (int chunky = 0; chunky < 16; ++chunky)
 	{
-		for (int superchunkx = 0; superchunkx < 12; ++superchunkx)
+		for (int chunkx = 0; chunkx < 16; ++chunkx)
 		{
-			std::stringstream ss;
-			int thissuperchunk = superchunkx + (superchunky * 12);
-			if (thissuperchunk < 16)
-			{
-				ss << "U7IFIX0" << std::hex << thissuperchunk;
-			}
-			else
-			{
-				ss << "U7IFIX" << std::hex << thissuperchunk;
-			}
-			std::string s = ss.str();
-            
-            std::transform(s.begin(), s.end(), s.begin(), ::toupper);
-            
-						s.insert(0, loadingPath.c_str());
-
-			FILE* u7thisifix = fopen(s.c_str(), "rb");
-            
-            if(u7thisifix == nullptr)
-            {
-                int stopper = 0;
-            }
-
-			//  Even though these files don't have an .flx description, 
-			//  these are flex files.  Flex files have a header of 80 bytes,
-			//  which is the same for every file: "Ultima VII Data File (C) 1992 Origin Inc."
-			char header[80];
-			fread(&header, sizeof(char), 80, u7thisifix);
-
-			//  This is followed two unsigned ints.  The first unsigned int is always the same, so we can ignore it.
-			//  The second is the number of g_objecTable in the file.
-			unsigned int throwaway;
-			unsigned int entrycount;
-			fread(&throwaway, sizeof(unsigned int), 1, u7thisifix);
-			fread(&entrycount, sizeof(unsigned int), 1, u7thisifix);
-
-			//  Now we have ten unsigned ints worth of data that we can ignore.
-			for (int i = 0; i < 10; ++i)
+			int thischunk = chunkx + (chunky * 16);
+
+			ByteSpan thisentry = u7thisifix.GetEntry(thischunk);
+			if (thisentry.IsEmpty())
 			{
-				fread(&throwaway, sizeof(unsigned int), 1, u7thisifix);
+				continue; // Offset of 0 means no object here.
 			}
 
-			struct entrydata
-			{
-				unsigned int offest;
-				unsigned int length;
-			};
+			ByteReader locationdata(thisentry);
 
-			unordered_map<unsigned int, entrydata> entrymap;
-			//  Now we have the data we want.  Each entry is 8 bytes long.
-			for (int i = 0; i < entrycount; ++i)
+			//  Each object is two unsigned shorts: location, then shape and frame.
+			for (unsigned int w = 0; w < thisentry.m_length / 4; ++w)
 			{
-				entrydata thisentry;
-				fread(&thisentry.offest, sizeof(unsigned int), 1, u7thisifix);
-				fread(&thisentry.length, sizeof(unsigned int), 1, u7thisifix);
-				entrymap[i] = thisentry;
+				unsigned short thisLocationData = locationdata.ReadU16();
+				unsigned short shapeData = locationdata.ReadU16();
+
+				IFIXObject object;
+				object.shape = shapeData & 0x3ff;
+				object.frame = (shapeData >> 10) & 0x1f;
+
+				int y = thisLocationData & 0xf;
+				int x = (thisLocationData >> 4) & 0xf;
+				int z = (thisLocationData >> 8) & 0xf;
+
+				object.x = (superchunkx * 256) + (chunkx * 16) + x;
+				object.y = z;
+				object.z = (superchunky * 256) + (chunky * 16) + y;
+				objects.push_back(object);
 			}
+		}
+	}
 
-			struct ShapeFrameIndex
-			{
-				unsigned int shape;
-				unsigned int frame;
-			};
+	return true;
+}
 
-			struct objectdata
-			{
-				ShapeFrameIndex shapeframe;
-				char chunkx;
-				char chunky;
-			};
+std::string LoadingState::SuperchunkFilename(const std::string& loadingPath, const std::string& prefix, int thissuperchunk)
+{
+	std::stringstream ss;
+	if (thissuperchunk < 16)
+	{
+		ss << prefix << "0" << std::hex << thissuperchunk;
+	}
+	else
+	{
+		ss << prefix << std::hex << thissuperchunk;
+	}
+	std::string s = ss.str();
 
-			//  Now, having processed the header, we can process the, you know, data.
-			for (int chunky = 0; chunky < 16; ++chunky)
-			{
-				for (int chunkx = 0; chunkx < 16; ++chunkx)
-				{
-					int thischunk = chunkx + (chunky * 16);
+	std::transform(s.begin(), s.end(), s.begin(), ::toupper);
 
-					entrydata thisentry = entrymap[thischunk];
-					if (thisentry.offest == 0)
-					{
-						continue; // Offset of 0 means no object here.
-					}
-					else
-					{
-						unsigned short* locationdata;
-						locationdata = (unsigned short*)malloc(sizeof(unsigned short) * (thisentry.length / 2));
-						fseek(u7thisifix, thisentry.offest * sizeof(char), SEEK_SET);
-						fread(locationdata, sizeof(unsigned char), thisentry.length, u7thisifix);
+	s.insert(0, loadingPath.c_str());
+	return s;
+}
 
-						for (int w = 0; w < (thisentry.length / 2); w += 2)
-						{
-							unsigned short thisLocationData = locationdata[w];
-							unsigned short shapeData = locationdata[w + 1];
+void LoadingState::ParseIFIX()
+{
+	std::string loadingPath(m_dataPath);
+	loadingPath.append("/STATIC/");
+
+	//  The 144 files are independent, so parse them all at once.  Creating the
+	//  objects stays serial and in superchunk order (in LoadIFIX()) so they get
+	//  exactly the same IDs they always have.
+	m_ifixObjects.clear();
+	m_ifixObjects.resize(144);
+	m_ifixOpened.assign(144, false);
 
-							int shape = shapeData & 0x3ff;
-							int frame = (shapeData >> 10) & 0x1f;
+	std::atomic<int> parsed(0);
+	g_ThreadPool->ParallelFor(0, 144, [&](int thissuperchunk)
+		{
+			std::string filename = SuperchunkFilename(loadingPath, "U7IFIX", thissuperchunk);
+			m_ifixOpened[thissuperchunk] = ParseIFIXSuperchunk(filename, thissuperchunk % 12, thissuperchunk / 12, m_ifixObjects[thissuperchunk]);
+			m_stages[LOADSTAGE_PARSEIFIX].m_progress = float(++parsed) / 144.0f;
+		});
+}
 
-							int y = thisLocationData & 0xf;
-							int x = (thisLocationData >> 4) & 0xf;
-							int z = (thisLocationData >> 8) & 0xf;
+void LoadingState::LoadIFIX()
+{
+	std::string loadingPath(m_dataPath);
+	loadingPath.append("/STATIC/");
 
-							AddObject(shape, frame, GetNextID(), (superchunkx * 256) + (chunkx * 16) + x, z, (superchunky * 256) + (chunky * 16) + y);
+	size_t totalObjects = 0;
+	for (auto& objects : m_ifixObjects)
+	{
+		totalObjects += objects.size();
+	}
+	g_ObjectList.Reserve(g_ObjectList.size() + totalObjects);
 
-							int stopper = 0;
-						}
-					}
-				}
-			}
+	for (int thissuperchunk = 0; thissuperchunk < 144; ++thissuperchunk)
+	{
+		if (!m_ifixOpened[thissuperchunk])
+		{
+			Log("Could not open " + SuperchunkFilename(loadingPath, "U7IFIX", thissuperchunk));
+			continue;
+		}
 
-			int stopper = 0;
-			fclose(u7thisifix);
+		for (auto& object : m_ifixObjects[thissuperchunk])
+		{
+			AddObject(object.shape, object.frame, GetNextID(), object.x, object.y, object.z);
 		}
+
+		m_stages[LOADSTAGE_IFIX].m_progress = float(thissuperchunk + 1) / 144.0f;
 	}
+
+	m_ifixObjects.clear();
 }
 
 void LoadingState::MakeMap()
 {
-	g_World.resize(3072);
-	for (int i = 0; i < 3072; ++i)
+	//  The tiles themselves are looked up through g_worldTiles; all that's left
+	//  is the objects that are part of each chunk.
+	if (m_chunkTemplates)
 	{
-		g_World[i].resize(3072);
+		g_chunkTemplates.Build(g_worldTiles);
+		m_stages[LOADSTAGE_MAKEMAP].m_progress = 1;
+		return;
 	}
 
-	//  Now, finally, we can create the world map.
 	for (int i = 0; i < 192; ++i)
 	{
 		for (int j = 0; j < 192; ++j)
 		{
-			int chunkid = g_chunkTypeMap[i][j];
-			for (int k = 0; k < 16; ++k)
+			//  When streaming, these are created with the rest of their superchunk.
+			if (m_streamRadius <= 0)
 			{
-				for (int l = 0; l < 16; ++l)
-				{
-					unsigned int thisdata = g_ChunkTypeList[chunkid][l][k];
-					g_World[j * 16 + k][i * 16 + l] = g_ChunkTypeList[chunkid][l][k];
+				AddChunkObjects(i, j);
+			}
+		}
 
+		m_stages[LOADSTAGE_MAKEMAP].m_progress = float(i + 1) / 192.0f;
+	}
+}
 
-					unsigned short shapenum = thisdata & 0x3ff;
-					unsigned short framenum = (thisdata >> 10) & 0x1f;
+void LoadingState::AddChunkObjects(int chunkx, int chunky, std::vector<ObjectHandle>* created)
+{
+	const uint16_t* tiles = g_worldTiles.GetChunkTiles(g_worldTiles.GetChunkType(chunkx, chunky));
+	for (int k = 0; k < 16; ++k)
+	{
+		for (int l = 0; l < 16; ++l)
+		{
+			unsigned int thisdata = tiles[l * 16 + k];
 
-					if (shapenum >= 150)
-					{
-						AddObject(shapenum, framenum, GetNextID(), (i * 16 + k), 0, (j * 16 + l));
-					}
+			unsigned short shapenum = thisdata & 0x3ff;
+			unsigned short framenum = (thisdata >> 10) & 0x1f;
+
+			if (shapenum >= 150)
+			{
+				ObjectHandle id = GetNextID();
+				AddObject(shapenum, framenum, id, (chunkx * 16 + k), 0, (chunky * 16 + l));
+				if (created != nullptr)
+				{
+					created->push_back(id);
 				}
 			}
 		}
 	}
 }
 
-void LoadingState::LoadIREG()
+void LoadingState::ParseIREG(ByteSpan data, int superchunkx, int superchunky, std::vector<IREGRecord>& records)
 {
-	std::string dataPath = g_Engine->m_EngineConfig.GetString("data_path");
-	std::string loadingPath(dataPath);
-	loadingPath.append("/GAMEDAT/");
+	ByteReader ireg(data);
+
+	//  Flags for putting objects in containers.
+	int containerRecord = -1;
+	bool containerOpen = false;
 
-	for (int superchunky = 0; superchunky < 12; ++superchunky)
+	while (!ireg.Eof())
 	{
-		for (int superchunkx = 0; superchunkx < 12; ++superchunkx)
+		//  Read the length of the object.
+		unsigned char length = ireg.ReadU8();
+		if (length == 6) //  Object.
 		{
-         std::stringstream ss;
-			int thissuperchunk = superchunkx + (superchunky * 12);
-			if (thissuperchunk < 16)
+			unsigned char x = ireg.ReadU8();
+			unsigned char y = ireg.ReadU8();
+
+			int chunkx = x >> 4;
+			int chunky = y >> 4;
+			int intx = x & 0x0f;
+			int inty = y & 0x0f;
+
+			int actualx = (superchunkx * 256) + (chunkx * 16) + intx;
+			int actualy = (superchunky * 256) + (chunky * 16) + inty;
+
+			unsigned short shapeData = ireg.ReadU16();
+			int shape = shapeData & 0x3ff;
+			int frame = (shapeData >> 10) & 0x1f;
+
+			unsigned char z = ireg.ReadU8();
+			float lift1 = 0;
+			float lift2 = 0;
+			if (z != 0)
 			{
-				ss << "U7IREG0" << std::hex << thissuperchunk;
+				lift1 = z >> 4;
+				lift2 = z & 0x0f;
+				//z *= 8;
 			}
-			else
+
+			unsigned char quality = ireg.ReadU8();
+
+			if (ireg.Failed())
 			{
-				ss << "U7IREG" << std::hex << thissuperchunk;
+				break;
 			}
-			std::string s = ss.str();
-            
-         std::transform(s.begin(), s.end(), s.begin(), ::toupper);
-            
-			s.insert(0, loadingPath.c_str());
 
-			FILE* u7thisireg = fopen(s.c_str(), "rb");
+			if (shape != 275 && shape != 607 && shape != 0) //  Eggs
+			{
+				IREGRecord record;
+				record.shape = shape;
+				record.frame = frame;
+				record.x = actualx;
+				record.z = actualy;
+				record.lift = lift1;
+				record.isContainer = false;
+				record.parent = containerOpen ? containerRecord : -1;
+				records.push_back(record);
+			}
+		}
+		else if (length == 12) // Container or Egg
+		{
+			unsigned char x = ireg.ReadU8(); // 1
+			unsigned char y = ireg.ReadU8(); // 2
+
+			int chunkx = x >> 4;
+			int chunky = y >> 4;
+			int intx = x & 0x0f;
+			int inty = y & 0x0f;
+
+			int actualx = (superchunkx * 256) + (chunkx * 16) + intx;
+			int actualy = (superchunky * 256) + (chunky * 16) + inty;
 
-			if (u7thisireg == nullptr)
+			unsigned short shapeData = ireg.ReadU16(); // 3, 4
+			int shape = shapeData & 0x3ff;
+			int frame = (shapeData >> 10) & 0x1f;
+
+			ireg.Skip(5); // 5-9
+
+			unsigned char z = ireg.ReadU8(); // 10
+			float lift1 = 0;
+			float lift2 = 0;
+			float lift3 = 0;
+			if (z != 0)
 			{
-				Log("Ultima VII files not found.  They should go into the Data/U7 folder.");
-				m_loadingFailed = true;
-				return;
+				lift1 = z >> 4;
+				lift2 = z & 0x0f;
+				lift3 = z / 8;
+
 			}
-			else
+
+			//  Soak up the next byte.
+			ireg.Skip(1);		// 11
+
+			//  Egg or container?  01 Egg, 00 container.
+			unsigned char eggOrContainer = ireg.ReadU8(); // 12
+
+			if (ireg.Failed())
 			{
-				//  Flags for putting objects in containers.
-				unsigned int containerId = 0;
-				bool containerOpen = false;
+				break;
+			}
 
-				while (!feof(u7thisireg))
-				{
-					//  Read the length of the object.
-					unsigned char length;
-					fread(&length, sizeof(unsigned char), 1, u7thisireg);
-					if (length == 6) //  Object.
-					{
-						unsigned char x;
-						unsigned char y;
-						fread(&x, sizeof(unsigned char), 1, u7thisireg);
-						fread(&y, sizeof(unsigned char), 1, u7thisireg);
-
-						int chunkx = x >> 4;
-						int chunky = y >> 4;
-						int intx = x & 0x0f;
-						int inty = y & 0x0f;
-
-						int actualx = (superchunkx * 256) + (chunkx * 16) + intx;
-						int actualy = (superchunky * 256) + (chunky * 16) + inty;
-
-						unsigned short shapeData;
-						fread(&shapeData, sizeof(unsigned short), 1, u7thisireg);
-						int shape = shapeData & 0x3ff;
-						int frame = (shapeData >> 10) & 0x1f;
-
-						unsigned char z;
-						fread(&z, sizeof(unsigned char), 1, u7thisireg);
-						float lift1 = 0;
-						float lift2 = 0;
-						if (z != 0)
-						{
-							lift1 = z >> 4;
-							lift2 = z & 0x0f;
-							//z *= 8;
-						}
+			//  Containers aren't put inside the open container; a new one just
+			//  replaces it, and a close record closes whichever is open.
+			IREGRecord record;
+			record.shape = shape;
+			record.frame = frame;
+			record.x = actualx;
+			record.z = actualy;
+			record.lift = lift1;
+			record.isContainer = true;
+			record.parent = -1;
+			records.push_back(record);
+
+			if (eggOrContainer == 0)
+			{
+				containerOpen = true;
+				containerRecord = (int)records.size() - 1;
+			}
+		}
+		else if(length == 1) //  Close container
+		{
+			containerOpen = false;
+		}
+	}
+}
 
-						
-						unsigned char quality;
-						fread(&quality, sizeof(unsigned char), 1, u7thisireg);
+void LoadingState::ParseIREGFiles()
+{
+	std::string loadingPath(m_dataPath);
+	loadingPath.append("/GAMEDAT/");
 
-						if (shape != 275 && shape != 607 && shape != 0) //  Eggs
-						{
-							int objectId = GetNextID();
-							AddObject(shape, frame, objectId, actualx, lift1, actualy);
+	m_iregRecords.clear();
+	m_iregRecords.resize(144);
+	m_iregOpened.assign(144, false);
 
-							if (containerOpen)
-							{
-								AddObjectToContainer(objectId, containerId);
-							}
-						}
-					}
-					else if (length == 12) // Container or Egg
-					{
-						//continue;
-						unsigned char x;
-						unsigned char y;
-						fread(&x, sizeof(unsigned char), 1, u7thisireg); // 1
-						fread(&y, sizeof(unsigned char), 1, u7thisireg); // 2
-
-						int chunkx = x >> 4;
-						int chunky = y >> 4;
-						int intx = x & 0x0f;
-						int inty = y & 0x0f;
-
-						int actualx = (superchunkx * 256) + (chunkx * 16) + intx;
-						int actualy = (superchunky * 256) + (chunky * 16) + inty;
-
-						unsigned short shapeData;
-						fread(&shapeData, sizeof(unsigned short), 1, u7thisireg); // 3, 4
-						int shape = shapeData & 0x3ff;
-						int frame = (shapeData >> 10) & 0x1f;
-
-						unsigned char sink;
-						for (int i = 0; i < 5; ++i)
-						{
-							fread(&sink, sizeof(unsigned char), 1, u7thisireg); // 5-9
-						}
+	//  Parse every file on the thread pool into a flat list of records...
+	std::atomic<int> parsed(0);
+	g_ThreadPool->ParallelFor(0, 144, [&](int thissuperchunk)
+		{
+			MappedFile u7thisireg;
+			if (u7thisireg.Open(SuperchunkFilename(loadingPath, "U7IREG", thissuperchunk)))
+			{
+				ParseIREG(u7thisireg.GetData(), thissuperchunk % 12, thissuperchunk / 12, m_iregRecords[thissuperchunk]);
+				m_iregOpened[thissuperchunk] = true;
+			}
+			m_stages[LOADSTAGE_PARSEIREG].m_progress = float(++parsed) / 144.0f;
+		});
+}
 
-						unsigned char z;
-						fread(&z, sizeof(unsigned char), 1, u7thisireg); // 10
-						float lift1 = 0;
-						float lift2 = 0;
-						float lift3 = 0;
-						if (z != 0)
-						{
-							lift1 = z >> 4;
-							lift2 = z & 0x0f;
-							lift3 = z / 8;
+void LoadingState::LoadIREG()
+{
+	//  ...then create the objects in file order, so the IDs and container
+	//  contents are exactly what reading the files one after another gives.
+	for (int thissuperchunk = 0; thissuperchunk < 144; ++thissuperchunk)
+	{
+		if (!m_iregOpened[thissuperchunk])
+		{
+			Log("Ultima VII files not found.  They should go into the Data/U7 folder.");
+			m_loadingFailed = true;
+			return;
+		}
 
-						}
+		CommitIREGRecords(m_iregRecords[thissuperchunk]);
+		m_stages[LOADSTAGE_IREG].m_progress = float(thissuperchunk + 1) / 144.0f;
+	}
 
-						//  Soak up the next 2 bytes.
-						unsigned char throwaway[1];
-						fread(&throwaway, sizeof(unsigned char), 1, u7thisireg);		// 11
+	m_iregRecords.clear();
+}
 
-						int id = GetNextID();
-						AddObject(shape, frame, id, actualx, lift1, actualy);
-						GetObjectFromID(id)->m_isContainer = true;
+void LoadingState::CommitIREGRecords(const std::vector<IREGRecord>& records, std::vector<ObjectHandle>* created)
+{
+	std::vector<ObjectHandle> ids(records.size());
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		const IREGRecord& record = records[i];
+		ids[i] = GetNextID();
+		AddObject(record.shape, record.frame, ids[i], record.x, record.lift, record.z);
 
-						//  Egg or container?  01 Egg, 00 container.
-						unsigned char eggOrContainer;
-						fread(&eggOrContainer, sizeof(unsigned char), 1, u7thisireg); // 12
-						if (eggOrContainer == 0)
-						{
-							containerOpen = true;
-							containerId = id;
-							//AddObject(shape, frame, containerId, actualx, lift1, actualy);
-						}
-					}
-					else if(length == 1) //  Close container
-					{
-						containerOpen = false;
-					}
-				}
+		if (record.isContainer)
+		{
+			GetObjectFromID(ids[i])->SetIsContainer(true);
+		}
+		else if (record.parent >= 0)
+		{
+			AddObjectToContainer(ids[i], ids[record.parent]);
+		}
+	}
+
+	if (created != nullptr)
+	{
+		created->insert(created->end(), ids.begin(), ids.end());
+	}
+}
+
+//  An 8-bit image, every pixel transparent.  raylib has no palette format, so
+//  it's "grayscale"; the shader knows better.
+static Image GenIndexedImage(int width, int height)
+{
+	Image image;
+	image.data = malloc(width * height);
+	memset(image.data, SHAPE_TRANSPARENT_INDEX, width * height);
+	image.width = width;
+	image.height = height;
+	image.mipmaps = 1;
+	image.format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+	return image;
+}
+
+//  Decodes every frame of an RLE object shape into CPU-side images.  This touches
+//  nothing but the shape data, the palette and the images it creates, so it's safe
+//  to run on a worker thread.  Non-RLE entries produce no frames.
+//  With indexed set, the frames are 8-bit palette indices instead of RGBA.
+static void DecodeShapeFrames(ByteSpan shapeEntry, const std::array<Color, 256>& palette, bool indexed, std::vector<Image>& frames)
+{
+	ByteReader shape(shapeEntry);
+	unsigned int firstData = shape.ReadU32();
+
+	//  If the first data is the same as the length of the shape entry, then this entry is run-length encoded.
+	if (firstData != shapeEntry.m_length)
+	{
+		return;
+	}
+
+	static_assert(sizeof(Color) == sizeof(unsigned int), "Color must be packed RGBA8");
+	unsigned int packedPalette[256];
+	memcpy(packedPalette, palette.data(), sizeof(packedPalette));
+
+	//  Next four bytes tell length of the header.
+	unsigned int headerLength = shape.ReadU32();
+	unsigned int frameCount = ((headerLength - 4) / 4);
+	std::vector<unsigned int> frameOffsets;
+	frameOffsets.resize(frameCount);
+	frameOffsets[0] = 0;
+	for (int i = 1; i < frameCount; ++i)
+	{
+		frameOffsets[i] = shape.ReadU32();
+	}
+
+	frames.resize(frameCount);
+
+	//  Read the frame data.
+	for (int i = 0; i < frameCount; ++i)
+	{
+		//  Seek to the start of this frame's data.
+		if (i > 0)
+		{
+			shape.Seek(frameOffsets[i]);
+		}
+
+		ShapeFrameHeader header;
+		if (!ReadShapeFrameHeader(shape, header))
+		{
+			frames[i] = indexed ? GenIndexedImage(1, 1) : GenImageColor(1, 1, Color{ 0, 0, 0, 0 });
+			continue;
+		}
+
+		if (indexed)
+		{
+			frames[i] = GenIndexedImage(header.width, header.height);
+			DecodeShapeFrameIndexed(shape, header, (unsigned char*)frames[i].data);
+		}
+		else
+		{
+			frames[i] = GenImageColor(header.width, header.height, Color{ 0, 0, 0, 0 });
+			DecodeShapeFrame(shape, header, packedPalette, (unsigned int*)frames[i].data);
+		}
+	}
+}
+
+//  shapes.bin holds, for each object shape (150-1023), the frame count and then
+//  each frame's width, height and RGBA pixels.  shapes8.bin is the same with
+//  palette indices.
+static bool ReadCachedShapes(ByteSpan payload, bool indexed, std::vector<std::vector<Image> >& decodedShapes)
+{
+	ByteReader reader(payload);
+	unsigned int bytesPerPixel = indexed ? 1 : 4;
+	bool damaged = false;
+	for (int thisShape = 150; thisShape < 1024 && !damaged; ++thisShape)
+	{
+		unsigned int frameCount = reader.ReadU32();
+		for (int i = 0; i < frameCount; ++i)
+		{
+			unsigned int width = reader.ReadU32();
+			unsigned int height = reader.ReadU32();
+			if (reader.Failed() || width == 0 || height == 0 || width > 4096 || height > 4096 || width * height * bytesPerPixel > reader.Remaining())
+			{
+				damaged = true;
+				break;
 			}
 
-			//int stopper = 0;
-			fclose(u7thisireg);
+			Image image;
+			image.data = malloc(width * height * bytesPerPixel);
+			image.width = width;
+			image.height = height;
+			image.mipmaps = 1;
+			image.format = indexed ? PIXELFORMAT_UNCOMPRESSED_GRAYSCALE : PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+			reader.Read(image.data, width * height * bytesPerPixel);
+			decodedShapes[thisShape].push_back(image);
+		}
+	}
+
+	if (damaged || reader.Failed() || !reader.Eof())
+	{
+		//  Throw away whatever we got and decode from scratch.
+		Log("The shape cache is damaged, rebuilding it.");
+		for (auto& frames : decodedShapes)
+		{
+			for (auto& image : frames)
+			{
+				UnloadImage(image);
+			}
+			frames.clear();
 		}
+		return false;
 	}
+
+	return true;
 }
 
-void LoadingState::CreateShapeTable()
+static void WriteCachedShapes(const std::string& filename, unsigned long long key, const std::vector<std::vector<Image> >& decodedShapes)
 {
+	AssetCacheWriter writer;
+	if (writer.Begin(filename, key))
+	{
+		for (int thisShape = 150; thisShape < 1024; ++thisShape)
+		{
+			writer.WriteU32((unsigned int)decodedShapes[thisShape].size());
+			for (auto& image : decodedShapes[thisShape])
+			{
+				writer.WriteU32(image.width);
+				writer.WriteU32(image.height);
+				writer.Write(image.data, GetPixelDataSize(image.width, image.height, image.format));
+			}
+		}
+	}
+
+	if (!writer.Finish())
+	{
+		Log("Could not write " + filename + ".");
+	}
+}
+
+void LoadingState::DecodeShapes()
+{
+	m_shapeLoadStartTime = GetTime();
+	float paletteTime = GetTime();
+
 	//  Load palette data
-	ifstream palette;
-	std::string dataPath = g_Engine->m_EngineConfig.GetString("data_path");
+	std::string dataPath = m_dataPath;
 	std::string loadingPath(dataPath);
 	loadingPath.append("/STATIC/PALETTES.FLX");
-	palette.open(loadingPath.c_str(), ios::binary);
-	if (!palette.good())
+	FlxArchive palette;
+	if (!palette.Open(loadingPath) || palette.GetEntry(0).m_length < 768)
 	{
 		Log("Ultima VII files not found.  They should go into the Data/U7/blackgate folder.");
-		throw("Ultima VII files not found.  They should go into the Data/U7/blackgate folder.");
+		m_loadingFailed = true;
+		return;
 	}
 
-	vector<FLXEntryData> paletteEntryMap = ParseFLXHeader(palette);
+	//  The first palette is the normal one; the rest are for lighting effects.
+	//  RGBA frames only ever use the first, but with indexed textures they all
+	//  go to the GPU so they can be swapped in.
+	m_palettes.clear();
+	for (unsigned int i = 0; i < palette.GetEntryCount(); ++i)
+	{
+		if (palette.GetEntry(i).m_length < 768)
+		{
+			break;
+		}
 
-	//  We only want the first palette for now.
-	palette.seekg(paletteEntryMap[0].offset);
-	unsigned char* paletteData = (unsigned char*)malloc(paletteEntryMap[0].length);
-	palette.read((char*)paletteData, paletteEntryMap[1].length);
+		const unsigned char* paletteData = palette.GetEntry(i).m_data;
+		for (int j = 0; j < 256; ++j)
+		{
+			unsigned char r = paletteData[j * 3];
+			unsigned char g = paletteData[j * 3 + 1];
+			unsigned char b = paletteData[j * 3 + 2];
+			m_palettes.push_back(Color{ (unsigned char)(r * 4), (unsigned char)(g * 4), (unsigned char)(b * 4), 255 });
+		}
 
-	//  Currently only loading the base palette.  Other palettes are for lighting effects.
-	for (int j = 0; j < 256; ++j)
-	{
-		unsigned char r = paletteData[j * 3];
-		unsigned char g = paletteData[j * 3 + 1];
-		unsigned char b = paletteData[j * 3 + 2];
-		m_palette[j].r = r * 4;
-		m_palette[j].g = g * 4;
-		m_palette[j].b = b * 4;
-		m_palette[j].a = 255;
+		m_palettes[i * 256 + 254] = Color{ 128, 128, 128, 128 };
+		m_palettes[i * 256 + SHAPE_TRANSPARENT_INDEX] = Color{ 0, 0, 0, 0 };
 	}
 
-	m_palette[254] = Color{ 128, 128, 128, 128 };
+	std::copy(m_palettes.begin(), m_palettes.begin() + 256, m_palette.begin());
 
-	palette.close();
+	//  Only indexed frames have transparent pixels in them.
+	m_palette[SHAPE_TRANSPARENT_INDEX].a = 255;
 
-	//  Load shape data
-	ifstream shapesFile;
-	std::string shapePath = dataPath.append("/STATIC/SHAPES.VGA");
-	shapesFile.open(shapePath.c_str(), ios::binary);
+	palette.Close();
+	paletteTime = GetTime() - paletteTime;
 
-	stringstream shapes;
-	shapes << shapesFile.rdbuf();
-	shapesFile.close();
+	//  The terrain texture, the chunk textures and the decoded shapes only depend on
+	//  the files below, so after the first run they come out of the asset cache.
+	float cacheTime = GetTime();
+	std::string shapePath = dataPath + "/STATIC/SHAPES.VGA";
+	std::string chunkPath = dataPath + "/STATIC/U7CHUNKS";
+	m_cacheKey = AssetCache::HashFiles({ loadingPath, shapePath, chunkPath, "Data/shapetable.dat" });
 
-	vector<FLXEntryData> shapeEntryMap = ParseFLXHeader(shapes);
+	Image& tempImage = g_Terrain->GetTerrainTexture();
+	unsigned int terrainSize = tempImage.width * tempImage.height * 4;
 
-	bool test = true;
+	AssetCache terrainCache;
+	bool terrainCached = m_useAssetCache && terrainCache.Open("Data/cache/terrain.bin", m_cacheKey) && terrainCache.GetPayload().m_length == terrainSize;
+	AssetCache shapeCache;
+	std::string shapeCacheName = g_indexedTextures ? "Data/cache/shapes8.bin" : "Data/cache/shapes.bin";
+	bool shapesCached = m_useAssetCache && shapeCache.Open(shapeCacheName, m_cacheKey);
+	cacheTime = GetTime() - cacheTime;
+	float terrainTime = GetTime();
 
-		//  The first 150 entries (0-149) are terrain textures.  They are not
-	//  rle-encoded.  Splat them directly to the terrain texture.
-	Image& tempImage = g_Terrain->GetTerrainTexture();
-	for (int thisShape = 0; thisShape < 150; ++thisShape)
+	//  Load shape data
+	FlxArchive shapes;
+	if ((!terrainCached || !shapesCached) && (!shapes.Open(shapePath) || shapes.GetEntryCount() < 1024))
 	{
-		shapes.seekg(shapeEntryMap[thisShape].offset);
-		int numFrames = shapeEntryMap[thisShape].length / 64;
-		for (int thisFrame = 0; thisFrame < numFrames; ++thisFrame)
+		Log("Ultima VII files not found.  They should go into the Data/U7/blackgate folder.");
+		m_loadingFailed = true;
+		return;
+	}
+
+	if (terrainCached)
+	{
+		memcpy(tempImage.data, terrainCache.GetPayload().m_data, terrainSize);
+	}
+	else
+	{
+		//  The first 150 entries (0-149) are terrain textures.  They are not
+		//  rle-encoded.  Splat them directly to the terrain texture.
+		unsigned int packedPalette[256];
+		memcpy(packedPalette, m_palette.data(), sizeof(packedPalette));
+		for (int thisShape = 0; thisShape < 150; ++thisShape)
 		{
-			if (thisShape == 12 && thisFrame == 0)
-				continue;
-			for (int i = 0; i < 8; ++i)
+			ByteSpan shape = shapes.GetEntry(thisShape);
+			int numFrames = shape.m_length / 64;
+			//  Anything past the bottom of the terrain texture is dropped.
+			if (numFrames > tempImage.height / 8)
 			{
-				for (int j = 0; j < 8; ++j)
+				numFrames = tempImage.height / 8;
+			}
+
+			for (int thisFrame = 0; thisFrame < numFrames; ++thisFrame)
+			{
+				if (thisShape == 12 && thisFrame == 0)
+					continue;
+				for (int i = 0; i < 8; ++i)
 				{
-					unsigned char Value = ReadU8(shapes);
-					ImageDrawPixel(&tempImage, (thisShape * 8) + j, (thisFrame * 8) + i, m_palette[Value]);
+					unsigned int* row = (unsigned int*)tempImage.data + ((thisFrame * 8) + i) * tempImage.width + (thisShape * 8);
+					ExpandPaletteSpan(shape.m_data + (thisFrame * 64) + (i * 8), 8, packedPalette, row);
 				}
 			}
+		}
 
+		if (m_useAssetCache)
+		{
+			AssetCacheWriter writer;
+			if (writer.Begin("Data/cache/terrain.bin", m_cacheKey))
+			{
+				writer.Write(tempImage.data, terrainSize);
+			}
+			if (!writer.Finish())
+			{
+				Log("Could not write Data/cache/terrain.bin.");
+			}
 		}
 	}
+	terrainCache.Close();
 
 	g_Terrain->UpdateTerrainTexture(tempImage);
-	g_Terrain->Init();
-	Log("Done creating terrain.");
+	terrainTime = GetTime() - terrainTime;
 
-	struct frameData
+	float decodeTime = GetTime();
+
+	m_decodedShapes.clear();
+	m_decodedShapes.resize(1024);
+	std::vector<std::vector<Image> >& decodedShapes = m_decodedShapes;
+	if (!shapesCached || !ReadCachedShapes(shapeCache.GetPayload(), g_indexedTextures, decodedShapes))
 	{
-		unsigned int fileOffset;
-		short W2;
-		short W1;
-		short H1;
-		short H2;
-		unsigned int width;
-		unsigned int height;
-		int xDrawOffset;
-		int yDrawOffset;
-	};
-
-	float profilingTime = GetTime();
-
-	for (int thisShape = 150; thisShape < 1024; ++thisShape)
+		shapesCached = false;
+
+		//  The next 874 entries (150-1023) are objects.  Decoding them is pure CPU work
+		//  and each shape is independent, so spread it across the thread pool.  Only
+		//  the texture upload has to happen on the GL thread, in UploadShapes().
+		std::atomic<int> decoded(0);
+		g_ThreadPool->ParallelFor(150, 1024, [&](int thisShape)
+			{
+				DecodeShapeFrames(shapes.GetEntry(thisShape), m_palette, g_indexedTextures, decodedShapes[thisShape]);
+				m_stages[LOADSTAGE_DECODESHAPES].m_progress = float(++decoded) / 874.0f;
+			});
+
+		if (m_useAssetCache)
+		{
+			WriteCachedShapes(shapeCacheName, m_cacheKey, decodedShapes);
+		}
+	}
+	shapeCache.Close();
+	shapes.Close();
+
+	decodeTime = GetTime() - decodeTime;
+
+	Log("    palette: " + std::to_string(paletteTime) + "  cache check: " + std::to_string(cacheTime) + "  terrain" + (terrainCached ? " (cached): " : ": ") + std::to_string(terrainTime) +
+		(shapesCached ? std::string("  decode (cached): ") : "  decode (" + std::to_string(g_ThreadPool->GetNumThreads() + 1) + " threads): ") + std::to_string(decodeTime));
+}
+
+//  Maps shapetable.bin, importing shapetable.dat into it first if the text has
+//  changed since it was last imported.
+void LoadingState::LoadShapeTable()
+{
+	if (m_shapeTable.Open("Data/shapetable.bin", "Data/shapetable.dat"))
 	{
-		//  The next 874 entries (150-1023) are objects.
+		return;
+	}
 
-		//  Read the shape data.
+	double startTime = GetTime();
+	if (!ShapeTableFile::ImportText("Data/shapetable.dat", "Data/shapetable.bin") || !m_shapeTable.Open("Data/shapetable.bin", "Data/shapetable.dat"))
+	{
+		Log("Could not load the shape table from Data/shapetable.dat.");
+		return;
+	}
 
-		shapes.seekg(shapeEntryMap[thisShape].offset);
-		unsigned int headerStart = shapes.tellg();
-		unsigned int firstData = ReadU32(shapes);
+	Log("Imported shapetable.dat in " + std::to_string(GetTime() - startTime));
+}
 
-		//  If the first data is the same as the length of the shape entry, then this entry is run-length encoded.
-		if (firstData == shapeEntryMap[thisShape].length)
+//  Called a slice at a time on the main thread: first every shape's textures are
+//  created from the decoded images, then the shape table sets them up, which
+//  creates more textures.  Returns true when it's all done.
+bool LoadingState::UploadShapes()
+{
+	//  Setting the shapes up builds models that point at the palettes.
+	if (g_indexedTextures && g_paletteTexture.id == 0 && !m_palettes.empty())
+	{
+		Image palettes{ m_palettes.data(), 256, int(m_palettes.size() / 256), 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+		g_paletteTexture = LoadTextureFromImage(palettes);
+		SetActivePalette(0);
+	}
+
+	if (m_nextShapeToUpload < 1024)
+	{
+		int thisShape = m_nextShapeToUpload++;
+		for (size_t i = 0; i < m_decodedShapes[thisShape].size(); ++i)
 		{
-			//  Next four bytes tell length of the header.
-			unsigned int headerLength = ReadU32(shapes);
-			unsigned int frameCount = ((headerLength - 4) / 4);
-			std::vector<frameData> frameOffsets;
-			frameOffsets.resize(frameCount);
-			frameOffsets[0].fileOffset = 0;
-			for (int i = 1; i < frameCount; ++i)
+			//  Anything past the last frame slot would have nowhere to go.
+			if (i >= g_shapeTable[thisShape].size())
 			{
-				frameOffsets[i].fileOffset = ReadU32(shapes);
+				UnloadImage(m_decodedShapes[thisShape][i]);
+				continue;
 			}
 
-			//  Read the frame data.
-			for (int i = 0; i < frameCount; ++i)
-			{
-				ShapeData& shapeData = g_shapeTable[thisShape][i];
-				//  Seek to the start of this frame's data.
-				if (i > 0)
-				{
-					shapes.seekg(headerStart + frameOffsets[i].fileOffset);
-				}
-
-				frameOffsets[i].W2 = ReadS16(shapes);
-				frameOffsets[i].W1 = ReadS16(shapes);
-				frameOffsets[i].H1 = ReadS16(shapes);
-				frameOffsets[i].H2 = ReadS16(shapes);
+			ShapeData& shapeData = g_shapeTable[thisShape][i];
+			shapeData.CreateDefaultTexture();
+			shapeData.SetDefaultTexture(m_decodedShapes[thisShape][i]);
+		}
+		m_decodedShapes[thisShape].clear();
 
-				frameOffsets[i].height = frameOffsets[i].H1 + frameOffsets[i].H2 + 1;
-				frameOffsets[i].width = frameOffsets[i].W2 + frameOffsets[i].W1 + 1;
+		m_stages[LOADSTAGE_UPLOADSHAPES].m_progress = float(m_nextShapeToUpload - 150) / (874.0f * 2);
+		return false;
+	}
 
-				frameOffsets[i].xDrawOffset = frameOffsets[i].W2;
-				frameOffsets[i].yDrawOffset = frameOffsets[i].H2;
+	if (m_nextShapeToDeserialize < 1024 && m_shapeTable.IsOpen())
+	{
+		m_shapeTable.ApplyShape(m_nextShapeToDeserialize++);
 
-				shapeData.CreateDefaultTexture();
-				Image tempImage = GenImageColor(frameOffsets[i].width, frameOffsets[i].height, Color{ 0, 0, 0, 0 });
-				//  Read each span.  Spans can be either RLE or raw pixel data.
-				while (true)
-				{
-					unsigned short blockData = ReadU16(shapes);
-					unsigned short spanLength = blockData >> 1;
-					unsigned short spanType = blockData & 1;
+		m_stages[LOADSTAGE_UPLOADSHAPES].m_progress = float(874 + m_nextShapeToDeserialize - 150) / (874.0f * 2);
+		return false;
+	}
 
-					if (blockData == 0)
-					{
-						break; //  There are no more spans; we're done with this frame.
-					}
+	m_shapeTable.Close();
+	m_decodedShapes.clear();
 
-					short xStart = ReadS16(shapes);
-					short yStart = ReadS16(shapes);
-					xStart += frameOffsets[i].width - frameOffsets[i].xDrawOffset - 1;
-					yStart += frameOffsets[i].height - frameOffsets[i].yDrawOffset - 1;
+	Log("Time to load shapes: " + std::to_string(GetTime() - m_shapeLoadStartTime));
+	return true;
+}
 
-					if (spanType == 0) // Not RLE, raw pixel data.
-					{
-						for (int i = 0; i < spanLength; ++i)
-						{
-							unsigned char Value = ReadU8(shapes);
-							ImageDrawPixel(&tempImage, xStart + i, yStart, m_palette[Value]);
-						}
-					}
-					else // RLE.
-					{
-						int endX = xStart + spanLength;
+//  Only reads the images the shapes have already set up, so it can run
+//  alongside everything after the upload.
+void LoadingState::PackShapeAtlas()
+{
+	if (!m_useShapeAtlas)
+	{
+		return;
+	}
 
-						while (xStart < endX)
-						{
-							unsigned char runData = ReadU8(shapes);
-							int runLength = runData >> 1;
-							int runType = runData & 1;
+	double startTime = GetTime();
 
-							if (runType == 0) // Once again, non-RLE
-							{
-								for (int i = 0; i < runLength; ++i)
-								{
-									unsigned char Value = ReadU8(shapes);
-									ImageDrawPixel(&tempImage, xStart + i, yStart, m_palette[Value]);
-								}
-							}
-							else
-							{
-								unsigned char Value = ReadU8(shapes);
-								for (int i = 0; i < runLength; ++i)
-								{
-									ImageDrawPixel(&tempImage, xStart + i, yStart, m_palette[Value]);
-								}
-							}
-							xStart += runLength;
-						}
-					}
-				}
-				shapeData.SetDefaultTexture(tempImage);
+	std::vector<Image> images;
+	m_atlasIndices.assign(1024 * 32, -1);
+	for (int shape = 150; shape < 1024; ++shape)
+	{
+		for (int frame = 0; frame < 32; ++frame)
+		{
+			if (g_shapeTable[shape][frame].IsValid())
+			{
+				m_atlasIndices[shape * 32 + frame] = int(images.size());
+				g_shapeTable[shape][frame].AddAtlasImages(images);
 			}
-
-			continue;
 		}
-		else  //  This entry is not encoded.
-		{
+	}
 
-		}
+	g_ShapeAtlas->Pack(images);
+	g_ShapeAtlas->LogStats();
+	Log("Packed shape atlas in " + std::to_string(GetTime() - startTime));
+}
+
+//  Uploads the atlas pages, then points the shapes at them a shape at a time.
+bool LoadingState::UploadShapeAtlas()
+{
+	if (!m_useShapeAtlas)
+	{
+		return true;
 	}
 
-	ifstream file("Data/shapetable.dat");
-	if (file.is_open())
+	if (m_nextShapeToAtlas == 150)
 	{
-		for (int i = 150; i < 1024; ++i)
+		g_ShapeAtlas->Upload();
+	}
+
+	if (m_nextShapeToAtlas < 1024)
+	{
+		int thisShape = m_nextShapeToAtlas++;
+		for (int frame = 0; frame < 32; ++frame)
 		{
-			for (int j = 0; j < 32; ++j)
+			int index = m_atlasIndices[thisShape * 32 + frame];
+			if (index >= 0)
 			{
-				ShapeData& shapeData = g_shapeTable[i][j];
-				shapeData.Deserialize(file);
+				g_shapeTable[thisShape][frame].UseAtlas(&g_ShapeAtlas->GetRect(index));
 			}
 		}
-		file.close();
+
+		m_stages[LOADSTAGE_SHAPEATLAS].m_progress = float(m_nextShapeToAtlas - 150) / 874.0f;
+		return false;
 	}
 
-	profilingTime = GetTime() - profilingTime;
-	Log("Time to load shapes: " + std::to_string(profilingTime));
+	m_atlasIndices.clear();
+	return true;
+}
+
+//  Gets the chunk textures into m_chunkCache, composing and writing them first if
+//  the cache is stale.  The main thread then makes textures out of them.
+void LoadingState::CreateChunkTextures()
+{
+	const unsigned int chunkImageSize = 128 * 128 * 4;
+
+	AssetCache& chunkCache = m_chunkCache;
+	if (!chunkCache.Open("Data/cache/chunks.bin", m_cacheKey) || chunkCache.GetPayload().m_length != 3072 * chunkImageSize)
+	{
+		//  Compose them one at a time straight into the cache file, then use the
+		//  cache just like we would on the next run.
+		std::vector<unsigned char> chunkImage(chunkImageSize);
+		unsigned short prevShape = 0;
+		unsigned short prevFrame = 0;
+
+		AssetCacheWriter writer;
+		if (writer.Begin("Data/cache/chunks.bin", m_cacheKey))
+		{
+			for (unsigned int i = 0; i < 3072; ++i)
+			{
+				g_Terrain->ComposeChunkImage(i, chunkImage.data(), prevShape, prevFrame);
+				writer.Write(chunkImage.data(), chunkImageSize);
+				m_stages[LOADSTAGE_TERRAIN].m_progress = float(i + 1) / 3072.0f;
+			}
+		}
+
+		if (!writer.Finish() || !chunkCache.Open("Data/cache/chunks.bin", m_cacheKey))
+		{
+			Log("Could not write Data/cache/chunks.bin.");
+			chunkCache.Close();
+		}
+	}
 }
 
 void LoadingState::LoadModels()
@@ -907,7 +1269,7 @@ void LoadingState::CreateObjectTable()
 {
 	//  Open the two files that define the objects in the object table.
 	// Open the two files that define the objects in the object table.
-	std::string dataPath = g_Engine->m_EngineConfig.GetString("data_path");
+	std::string dataPath = m_dataPath;
 
 	std::stringstream tfa;
 	tfa << dataPath.c_str() << "/STATIC/TFA.DAT";
@@ -922,47 +1284,18 @@ void LoadingState::CreateObjectTable()
 	std::stringstream text;
 	text << dataPath.c_str() << "/STATIC/TEXT.FLX";
 
-	ifstream textfile(text.str(), ios::binary);
-
-	char header[80];
-	textfile.read(header, sizeof(header));
-
-	//  This is followed two unsigned ints.  The first unsigned int is always the same, so we can ignore it.
-	//  The second is the number of g_objectTable in the file.
-	unsigned int throwaway = 0;
-	textfile.read((char*)&throwaway, sizeof(throwaway));
-
-	unsigned int entrycount = 0;
-	textfile.read((char*)&entrycount, sizeof(entrycount));
-
-	//  Now we have ten unsigned ints worth of data that we can ignore.
-	for (int i = 0; i < 10; ++i)
-	{
-		textfile.read((char*)&throwaway, sizeof(throwaway));
-	}
-
-	std::vector<FLXEntryData> entrymap;
-	entrymap.resize(entrycount);
-	//  Now we have the data we want.  Each entry is 8 bytes long.
-	for (int i = 0; i < entrycount; ++i)
-	{
-		FLXEntryData thisentry;
-		thisentry.length = 0;
-		thisentry.offset = 0;
-		textfile.read((char*)&thisentry.offset, sizeof(thisentry.offset));
-		textfile.read((char*)&thisentry.length, sizeof(thisentry.length));
-		entrymap[i] = thisentry;
-	}
+	FlxArchive textfile;
+	textfile.Open(text.str());
 
 	std::vector<std::string> shapeNames;
-	for (int i = 0; i < entrycount; ++i)
+	for (unsigned int i = 0; i < textfile.GetEntryCount(); ++i)
 	{
-		textfile.seekg(entrymap[i].offset);
-		char* thisname = new char[entrymap[i].length];
-		textfile.read(thisname, entrymap[i].length);
-		shapeNames.push_back(std::string(thisname));
-		delete[] thisname;
+		//  Entries are NUL-terminated, but don't trust that.
+		ByteSpan thisname = textfile.GetEntry(i);
+		const char* begin = (const char*)thisname.m_data;
+		shapeNames.push_back(std::string(begin, std::find(begin, begin + thisname.m_length, '\0')));
 	}
+	shapeNames.resize(1024);
 
 	//  Read the object table.
 
@@ -1005,77 +1338,36 @@ void LoadingState::CreateObjectTable()
 }
 
 
-//  Most Ultima VII files are flex files.  Thus, a general function that can
-//  parse flex file headers.  This function takes a FILE* and returns a vector
-//  of FLXEntryData, which is a struct containing the offset and length of
-//  each entry in the file.  It moves the file pointers to the point where
-//  the calling code can immediately start reading out data.
-std::vector<LoadingState::FLXEntryData> LoadingState::ParseFLXHeader(istream &file)
+void LoadingState::LoadInitialGameState()
 {
-	char header[80];
-	file.read(header, sizeof(header));
-
-	//  This is followed two unsigned ints.  The first unsigned int is always the same, so we can ignore it.
-	//  The second is the number of g_objecTable in the file.
-	unsigned int throwaway;
-	unsigned int entrycount;
-	file.read(reinterpret_cast<char*>(&throwaway), sizeof(throwaway));
-	file.read(reinterpret_cast<char*>(&entrycount), sizeof(entrycount));
-
-	//  Now we have ten unsigned ints worth of data that we can ignore.
-	for (int i = 0; i < 10; ++i)
-	{
-		unsigned int throwaway;
-		file.read(reinterpret_cast<char*>(&throwaway), sizeof(unsigned int));
-	}
+	//  Load shape data
+	std::string dataPath = m_dataPath;
+	std::string initGamePath = dataPath.append("/STATIC/INITGAME.DAT");
+	FlxArchive subFileArchive;
+	subFileArchive.Open(initGamePath);
 
-	std::vector<FLXEntryData> entrymap;
-	entrymap.resize(entrycount);
-	//  Now we have the data we want.  Each entry is 8 bytes long.
-	for (int i = 0; i < entrycount; ++i)
+	for (unsigned int node = 0; node < subFileArchive.GetEntryCount(); ++node)
 	{
-		FLXEntryData thisentry;
-		thisentry.offset = ReadS32(file);
-		if (thisentry.offset == 0) //  Offset of 0 means no object here.
+		if (subFileArchive.GetEntry(node).m_length < 13)
 		{
-			thisentry.length = 0;
 			continue;
 		}
-		thisentry.length = ReadS32(file);
-		entrymap[i] = thisentry;
-	}
 
-	return entrymap;
-}
+		//  Positions are logged relative to the start of the file, so read from the whole file.
+		ByteReader subFiles(subFileArchive.GetData());
+		subFiles.Seek(subFileArchive.GetEntries()[node].offset);
 
-void LoadingState::LoadInitialGameState()
-{
-	//  Load shape data
-	std::string dataPath = g_Engine->m_EngineConfig.GetString("data_path");
-	ifstream initGameFile;
-	std::string initGamePath = dataPath.append("/STATIC/INITGAME.DAT");
-	initGameFile.open(initGamePath.c_str(), ios::binary);
-
-	stringstream subFiles;
-	subFiles << initGameFile.rdbuf();
-	initGameFile.close();
-
-	vector<FLXEntryData> subFileMap = ParseFLXHeader(subFiles);
-
-	for (auto node = subFileMap.begin(); node != subFileMap.end(); ++node)
-	{
-		subFiles.seekg(node->offset);
 		//  First thirteen characters are the filename.
 		char filename[13];
-		subFiles.read(filename, 13);
+		subFiles.Read(filename, 13);
 
 		//  Based on the filename, do...something.
 		if (!strncmp(filename, "npc.dat", 6))
 		{
-			short npcCount1 = ReadU16(subFiles);
-			short npcCount2 = ReadU16(subFiles);
+			short npcCount1 = subFiles.ReadU16();
+			short npcCount2 = subFiles.ReadU16();
 			int fullcount = npcCount1 + npcCount2;
-			int filepos = subFiles.tellg();
+			int filepos = subFiles.Tell();
 			Log("File position: " + to_string(filepos));
 			for (int i = 0; i < fullcount; ++i)
 			{
@@ -1088,69 +1380,69 @@ void LoadingState::LoadInitialGameState()
 				Log("NPC block size: " + std::to_string(size));
 				NPCblock thisNPC;
 				
-				thisNPC.x = ReadU8(subFiles);
-				thisNPC.y = ReadU8(subFiles);
-				thisNPC.shapeId = ReadU16(subFiles);
+				thisNPC.x = subFiles.ReadU8();
+				thisNPC.y = subFiles.ReadU8();
+				thisNPC.shapeId = subFiles.ReadU16();
 
 				unsigned int shapenum = thisNPC.shapeId & 0x3ff;
 				unsigned int framenum = thisNPC.shapeId >> 10;
 
-				thisNPC.type = ReadU16(subFiles);
-				thisNPC.proba = ReadU8(subFiles);
-				thisNPC.data1 = ReadU16(subFiles);
-				thisNPC.lift = ReadU8(subFiles);
-				thisNPC.data2 = ReadU16(subFiles);
+				thisNPC.type = subFiles.ReadU16();
+				thisNPC.proba = subFiles.ReadU8();
+				thisNPC.data1 = subFiles.ReadU16();
+				thisNPC.lift = subFiles.ReadU8();
+				thisNPC.data2 = subFiles.ReadU16();
 
 				int chunkx = thisNPC.proba % 12;
 				int chunky = thisNPC.proba / 12;
 
-				thisNPC.index = ReadU16(subFiles);
-				thisNPC.referent = ReadU16(subFiles);
-				thisNPC.status = ReadU16(subFiles);
+				thisNPC.index = subFiles.ReadU16();
+				thisNPC.referent = subFiles.ReadU16();
+				thisNPC.status = subFiles.ReadU16();
 
 				AddObject(shapenum, 16, GetNextID(), chunkx * 16 * 16 + thisNPC.x, thisNPC.lift >> 4, chunky * 16 * 16 + thisNPC.y);
 
-				thisNPC.str = ReadU8(subFiles);
-				thisNPC.dex = ReadU8(subFiles);
-				thisNPC.iq = ReadU8(subFiles);
-				thisNPC.combat = ReadU8(subFiles);
-				thisNPC.activity = ReadU8(subFiles);
-				thisNPC.DAM = ReadU8(subFiles);
+				thisNPC.str = subFiles.ReadU8();
+				thisNPC.dex = subFiles.ReadU8();
+				thisNPC.iq = subFiles.ReadU8();
+				thisNPC.combat = subFiles.ReadU8();
+				thisNPC.activity = subFiles.ReadU8();
+				thisNPC.DAM = subFiles.ReadU8();
 
-				subFiles.read(thisNPC.soak1, 3);
+				subFiles.Read(thisNPC.soak1, 3);
 
-				thisNPC.status2 = ReadU16(subFiles);
-				thisNPC.index2 = ReadU8(subFiles);
+				thisNPC.status2 = subFiles.ReadU16();
+				thisNPC.index2 = subFiles.ReadU8();
 
-				subFiles.read(thisNPC.soak2, 2);
+				subFiles.Read(thisNPC.soak2, 2);
 
-				thisNPC.xp = ReadU32(subFiles);
-				thisNPC.training = ReadU8(subFiles);
-				thisNPC.primary = ReadU16(subFiles);
-				thisNPC.secondary = ReadU16(subFiles);
-				thisNPC.oppressor = ReadU16(subFiles);
-				thisNPC.ivrx = ReadU16(subFiles);
-				thisNPC.ivry = ReadU16(subFiles);
-				thisNPC.svrx = ReadU16(subFiles);
-			   thisNPC.svry = ReadU16(subFiles);
-				thisNPC.status3 = ReadU16(subFiles);
+				thisNPC.xp = subFiles.ReadU32();
+				thisNPC.training = subFiles.ReadU8();
+				thisNPC.primary = subFiles.ReadU16();
+				thisNPC.secondary = subFiles.ReadU16();
+				thisNPC.oppressor = subFiles.ReadU16();
+				thisNPC.ivrx = subFiles.ReadU16();
+				thisNPC.ivry = subFiles.ReadU16();
+				thisNPC.svrx = subFiles.ReadU16();
+			   thisNPC.svry = subFiles.ReadU16();
+				thisNPC.status3 = subFiles.ReadU16();
 
-				subFiles.read(thisNPC.soak3, 5);
+				subFiles.Read(thisNPC.soak3, 5);
 
-				thisNPC.acty = ReadU8(subFiles);
+				thisNPC.acty = subFiles.ReadU8();
 
-				subFiles.read(thisNPC.soak4, 29);
+				subFiles.Read(thisNPC.soak4, 29);
 
-				thisNPC.SN = ReadU8(subFiles);
-				thisNPC.V1 = ReadU8(subFiles);
-				thisNPC.V2 = ReadU8(subFiles);
-				thisNPC.food = ReadU8(subFiles);
+				thisNPC.SN = subFiles.ReadU8();
+				thisNPC.V1 = subFiles.ReadU8();
+				thisNPC.V2 = subFiles.ReadU8();
+				thisNPC.food = subFiles.ReadU8();
 
-				subFiles.read(thisNPC.soak5, 9);
+				subFiles.Read(thisNPC.soak5, 9);
 
-				subFiles.read(thisNPC.name, 16);
+				subFiles.Read(thisNPC.name, 16);
 
-				int newfilepos = subFiles.tellg();
+				int newfilepos = subFiles.Tell();
 				Log("File position after avatar: " + to_string(newfilepos));
 				Log("Size difference: " + to_string(newfilepos - filepos));
 				Log("Iolo starts at 2761 so there are " + to_string(2761 - newfilepos) + " bytes left.");
@@ -1161,14 +1453,14 @@ void LoadingState::LoadInitialGameState()
 					bool incontainer = false;
 					while (length != 0)
 					{
-						int pointerlocation = subFiles.tellg();
+						int pointerlocation = subFiles.Tell();
 						Log("File pointer is at " + to_string(pointerlocation));
-						length = ReadU8(subFiles);
+						length = subFiles.ReadU8();
 						if (length == 6) //  Object.
 						{
 							for (int i = 0; i < 6; ++i)
 							{
-								ReadU8(subFiles);
+								subFiles.ReadU8();
 							}
 						}
 						else if (length == 12) // container or egg
@@ -1176,7 +1468,7 @@ void LoadingState::LoadInitialGameState()
 							incontainer = true;
 							for (int i = 0; i < 12; ++i)
 							{
-								ReadU8(subFiles);
+								subFiles.ReadU8();
 							}
 						}
 						else if(length == 1)
@@ -3,6 +3,14 @@
 
 #include "Geist/State.h"
 #include "Geist/Gui.h"
+#include "FlxArchive.h"
+#include "AssetCache.h"
+#include "ShapeTableFile.h"
+#include "ObjectStore.h"
+#include <functional>
+#include <future>
+#include <atomic>
+#include <fstream>
 #include <list>
 #include <deque>
 #include <math.h>
@@ -54,6 +62,77 @@ struct NPCblock
    char name[16];
 };
 
+//  One object or container read from a U7IREGxx file, before it's been
+//  given an ID.
+struct IREGRecord
+{
+   unsigned short shape;
+   unsigned short frame;
+   int x;
+   int z;
+   float lift;
+   bool isContainer;
+   int parent; //  Index of the record for the container this is in, or -1.
+};
+
+//  One object read from a U7IFIXxx file.
+struct IFIXObject
+{
+   unsigned short shape;
+   unsigned short frame;
+   int x;
+   int y;
+   int z;
+};
+
+//  The loader is a set of stages with dependencies between them.  A stage's
+//  work runs on the thread pool as soon as everything it depends on is done;
+//  anything that has to touch GL goes in its main thread work instead, which
+//  is called a slice at a time between frames until it returns true.
+enum LoadingStageId
+{
+   LOADSTAGE_VERSION = 0,
+   LOADSTAGE_CHUNKS,
+   LOADSTAGE_MAP,
+   LOADSTAGE_OBJECTTABLE,
+   LOADSTAGE_MODELS,
+   LOADSTAGE_DECODESHAPES,
+   LOADSTAGE_SHAPETABLE,
+   LOADSTAGE_UPLOADSHAPES,
+   LOADSTAGE_SHAPEATLAS,
+   LOADSTAGE_TERRAIN,
+   LOADSTAGE_MAKEMAP,
+   LOADSTAGE_PARSEIFIX,
+   LOADSTAGE_IFIX,
+   LOADSTAGE_PARSEIREG,
+   LOADSTAGE_IREG,
+   LOADSTAGE_INITIALGAMESTATE,
+   LOADSTAGE_LAST
+};
+
+struct LoadingStage
+{
+   enum Status
+   {
+      WAITING = 0,
+      RUNNING,
+      MAINTHREAD,
+      DONE
+   };
+
+   std::string m_name;
+   std::vector<int> m_dependencies;
+   std::function<void()> m_work;
+   std::function<bool()> m_mainThreadWork;
+
+   Status m_status = WAITING;
+   std::future<void> m_future;
+   double m_startTime = 0;
+
+   //  0 to 1.  Stages that can tell how far along they are set this as they go.
+   std::atomic<float> m_progress{ 0.0f };
+};
+
 class LoadingState : public State
 {
 public:
@@ -72,34 +151,50 @@ public:
    void CreateTitleGUI();
    void UpdateLoading();
 
+   void CreateLoadingStages();
+   void SetStage(LoadingStageId id, const std::string& name, std::vector<int> dependencies,
+      std::function<void()> work, std::function<bool()> mainThreadWork = nullptr);
+   float GetLoadingProgress();
+
    void LoadChunks();
    void LoadMap();
-   void CreateShapeTable();
+   void DecodeShapes();
+   void LoadShapeTable();
+   bool UploadShapes();
+   void PackShapeAtlas();
+   bool UploadShapeAtlas();
+   void CreateChunkTextures();
    void CreateObjectTable();
+   void ParseIFIX();
    void LoadIFIX();
+   void ParseIREGFiles();
    void LoadIREG();
+
+   //  Parses one U7IFIXxx file into a list of objects, in file order.  Touches
+   //  nothing global, so superchunks can be parsed on worker threads.  Returns
+   //  false if the file couldn't be opened.
+   static bool ParseIFIXSuperchunk(const std::string& filename, int superchunkx, int superchunky, std::vector<IFIXObject>& objects);
+
+   //  U7IFIX00 through U7IFIX8F, and the same for U7IREG.
+   static std::string SuperchunkFilename(const std::string& loadingPath, const std::string& prefix, int thissuperchunk);
+
+   //  Creates the objects that are part of a chunk's own template.  If created
+   //  isn't null, their IDs are added to it.
+   static void AddChunkObjects(int chunkx, int chunky, std::vector<ObjectHandle>* created = nullptr);
+
+   //  Parses a whole U7IREGxx file without touching anything global, so files
+   //  can be parsed in parallel.  CommitIREGRecords() then creates the objects,
+   //  adding their IDs to created if it isn't null.
+   static void ParseIREG(ByteSpan data, int superchunkx, int superchunky, std::vector<IREGRecord>& records);
+   static void CommitIREGRecords(const std::vector<IREGRecord>& records, std::vector<ObjectHandle>* created = nullptr);
    void LoadVersion();
    void MakeMap();
    void LoadModels();
    //void MakeCSVFile();
    void LoadInitialGameState();
 
-   unsigned char ReadU8(std::istream &buffer);
-   unsigned short ReadU16(std::istream &buffer);
-   unsigned int  ReadU32(std::istream &buffer);
-   char ReadS8(std::istream &buffer);
-   short ReadS16(std::istream &buffer);
-   int  ReadS32(std::istream &buffer);
-
-   struct FLXEntryData
-   {
-      unsigned int offset;
-      unsigned int length;
-   };
-
-   std::vector<FLXEntryData> ParseFLXHeader(std::istream &file);
-
    std::array<Color, 256> m_palette;
+   std::vector<Color> m_palettes; //  Every palette in PALETTES.FLX, 256 entries each.
    
    Gui* m_LoadingGui = nullptr;
 
@@ -115,18 +210,48 @@ public:
 
    unsigned int m_currentChunk = 0;
 
-   bool m_loadingChunks = false;
-   bool m_loadingMap = false;
-   bool m_loadingShapes = false;
-   bool m_loadingObjects = false;
-   bool m_loadingIFIX = false;
-   bool m_loadingIREG = false;
-   bool m_loadingInitialGameState = false;
-   bool m_loadingVersion = false;
-   bool m_loadingModels = false;
-   bool m_makingMap = false;
-
-   bool m_loadingFailed = false;
+   std::array<LoadingStage, LOADSTAGE_LAST> m_stages;
+   bool m_stagesCreated = false;
+   double m_loadingStartTime = 0;
+
+   //  Read once on the main thread; Config isn't safe to use from the workers.
+   std::string m_dataPath;
+
+   //  stream_radius from engine.cfg.  If it's above zero, superchunk objects
+   //  aren't loaded here; g_SuperchunkStreamer creates them as they come in range.
+   float m_streamRadius = 0;
+
+   //  shape_atlas from engine.cfg.
+   bool m_useShapeAtlas = false;
+
+   //  tile_terrain from engine.cfg.  The terrain is drawn straight from the
+   //  chunk map and tiles, so the chunk images are never made.
+   bool m_tileTerrain = false;
+
+   //  chunk_templates from engine.cfg.  The objects in each chunk type are
+   //  kept in g_chunkTemplates and drawn from there, rather than every map
+   //  chunk getting its own copies of them.
+   bool m_chunkTemplates = false;
+
+   //  The load benchmark turns this off so it always times the real decode.
+   bool m_useAssetCache = true;
+
+   //  Handed from one stage to the next.
+   unsigned long long m_cacheKey = 0;
+   double m_shapeLoadStartTime = 0;
+   std::vector<std::vector<Image> > m_decodedShapes;
+   AssetCache m_chunkCache;
+   int m_nextShapeToUpload = 150;
+   int m_nextShapeToDeserialize = 150;
+   ShapeTableFile m_shapeTable;
+   std::vector<int> m_atlasIndices; //  Per shape * 32 + frame, the first of its images in the atlas, or -1.
+   int m_nextShapeToAtlas = 150;
+   std::vector<std::vector<IFIXObject> > m_ifixObjects;
+   std::vector<char> m_ifixOpened;
+   std::vector<std::vector<IREGRecord> > m_iregRecords;
+   std::vector<char> m_iregOpened;
+
+   std::atomic<bool> m_loadingFailed{ false };
 
    unsigned int m_currentShape = 0;
    unsigned int m_currentFrame = 0;
@@ -26,6 +26,9 @@
 #include "ShapeEditorState.h"
 #include "WorldEditorState.h"
 #include "ShapeData.h"
+#include "Benchmarks.h"
+#include "ShapeTableFile.h"
+#include "SuperchunkStreamer.h"
 #include <string>
 #include <sstream>
 #include <memory>
@@ -38,6 +41,47 @@ int main(int argv, char** argc)
 {
     SetTraceLogCallback(LoggingCallback);
 
+   //  "-bench <name> [-json <file>]" runs one of the benchmarks and exits without opening a window.
+   string jsonFilename;
+   for (int i = 1; i + 1 < argv; ++i)
+   {
+      if (string(argc[i]) == "-json")
+      {
+         jsonFilename = argc[i + 1];
+      }
+   }
+
+   for (int i = 1; i + 1 < argv; ++i)
+   {
+      if (string(argc[i]) == "-bench")
+      {
+         int result = RunBenchmark(argc[i + 1], jsonFilename);
+         if (result < 0)
+         {
+            Log("Unknown benchmark: " + string(argc[i + 1]), LOG_ERROR);
+            return 1;
+         }
+         return result;
+      }
+   }
+
+   //  "-importshapetable <in.dat> <out.bin>" and "-exportshapetable <in.bin> <out.dat>"
+   //  convert between the two shape table formats.
+   for (int i = 1; i + 2 < argv; ++i)
+   {
+      if (string(argc[i]) == "-importshapetable" || string(argc[i]) == "-exportshapetable")
+      {
+         bool import = string(argc[i]) == "-importshapetable";
+         bool result = import ? ShapeTableFile::ImportText(argc[i + 1], argc[i + 2]) : ShapeTableFile::ExportText(argc[i + 1], argc[i + 2]);
+         if (!result)
+         {
+            Log("Could not convert " + string(argc[i + 1]) + " to " + string(argc[i + 2]), LOG_ERROR);
+            return 1;
+         }
+         return 0;
+      }
+   }
+
    try
    {
       g_Engine = make_unique<Engine>();
@@ -45,6 +89,12 @@ int main(int argv, char** argc)
 
       g_alphaDiscard = LoadShader(NULL, "Data/Shaders/alphaDiscard.fs");
 
+      g_indexedTextures = g_Engine->m_EngineConfig.GetNumber("indexed_textures") != 0;
+      if (g_indexedTextures)
+      {
+         g_paletteShader = LoadShader(NULL, "Data/Shaders/paletteLookup.fs");
+      }
+
       rlDisableBackfaceCulling();
       rlEnableDepthTest();
       
@@ -129,6 +179,8 @@ int main(int argv, char** argc)
 
       Log("Creating terrain.");
       g_Terrain = make_unique<Terrain>();
+      g_SuperchunkStreamer = make_unique<SuperchunkStreamer>();
+      g_ShapeAtlas = make_unique<ShapeAtlas>();
 
       //  Create GUI elements
       g_BoxTL = make_unique<Sprite>(g_ResourceManager->GetTexture("Images/GUI/guielements.png", false), 0, 0, 2, 2);
@@ -208,6 +260,22 @@ int main(int argv, char** argc)
       exit(0);
    }
 
+   //  Before the engine, since it may still have reads running on the thread pool.
+   if (g_SuperchunkStreamer)
+   {
+      g_SuperchunkStreamer.reset();
+   }
+
+   if (g_ShapeAtlas)
+   {
+      g_ShapeAtlas.reset();
+   }
+
+   if (g_Terrain)
+   {
+      g_Terrain.reset();
+   }
+
    if (g_Engine)
    {
       g_Engine.reset();
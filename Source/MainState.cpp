@@ -7,6 +7,7 @@
 #include "Geist/Engine.h"
 #include "U7Globals.h"
 #include "MainState.h"
+#include "SuperchunkStreamer.h"
 #include "rlgl.h"
 
 #include <list>
@@ -96,6 +97,7 @@ void MainState::OnEnter()
 	AddConsoleString(std::string("Zoom in and out with mousewheel."));
 	AddConsoleString(std::string("Left-click in the minimap to teleport."));
 	AddConsoleString(std::string("Press F1 to switch to the Object Viewer."));
+	AddConsoleString(std::string("Press F3 to show object memory use."));
 	AddConsoleString(std::string("Press SPACE to toggle pixelation."));
 	AddConsoleString(std::string("Press ESC to exit."));
 	AddConsoleString(std::string("TOO HEAVY"));
@@ -125,25 +127,17 @@ void MainState::Update()
 
 		if (m_showObjects)
 		{
-			m_sortedVisibleObjects.clear();
-			float drawRange = g_cameraDistance * 1.5f;
-			for (unordered_map<int, shared_ptr<U7Object>>::iterator node = g_ObjectList.begin(); node != g_ObjectList.end(); ++node)
+			//  Nothing to redo while the camera and the world sit still.
+			CameraFrustum frustum = GetCameraFrustum(g_camera);
+			if (m_visibleObjects.Update(g_camera, frustum, m_heightCutoff))
 			{
-				(*node).second->Update();
-				//Vector3 centerPoint = Vector3Add((*node).second->m_Pos, (*node).second.get()->m_shapeData->m_boundingBoxCenterPoint);
-
-				float distance = Vector3Distance((*node).second->m_Pos, g_camera.target);
-				distance -= (*node).second->m_Pos.y;
-				if (distance < drawRange && (*node).second->m_Pos.y <= m_heightCutoff)
-				{
-					double distanceFromCamera = Vector3Distance((*node).second->m_Pos, g_camera.position) - (*node).second->m_Pos.y;
-					(*node).second->m_distanceFromCamera = distanceFromCamera;
-					m_sortedVisibleObjects.push_back((*node).second);
-					m_numberofDrawnUnits++;
-				}
+				g_chunkTemplates.GetVisibleInstances(g_camera, frustum, m_sortedVisibleTemplates);
 			}
 
-			std::sort(m_sortedVisibleObjects.begin(), m_sortedVisibleObjects.end(), [](shared_ptr<U7Object> a, shared_ptr<U7Object> b) { return a->m_distanceFromCamera > b->m_distanceFromCamera; });
+			for (ObjectHandle handle : m_visibleObjects.GetObjects())
+			{
+				g_ObjectList.Get(handle)->Update();
+			}
 		}
 
 		m_LastUpdate = GetTime();
@@ -153,6 +147,7 @@ void MainState::Update()
 
 	m_terrainUpdateTime = GetTime();
 	g_Terrain->Update();
+	g_SuperchunkStreamer->Update(g_camera.target);
 	m_terrainUpdateTime = GetTime() - m_terrainUpdateTime;
 
 	//  Handle special keyboard keys
@@ -167,6 +162,19 @@ void MainState::Update()
 
 	}
 
+	if (IsKeyPressed(KEY_F3))
+	{
+		vector<string> stats = g_ObjectList.GetStatsText();
+		stats.push_back("Visible objects: " + to_string(m_visibleObjects.GetConsidered()) + " considered, " + to_string(m_visibleObjects.GetAccepted()) + " accepted, "
+			+ to_string(m_visibleObjects.GetAdded()) + " added and " + to_string(m_visibleObjects.GetRemoved()) + " removed last update, "
+			+ (m_visibleObjects.GetSortUsedRadix() ? "radix" : "insertion") + " sorted.");
+		for (auto& line : stats)
+		{
+			AddConsoleString(line);
+			Log(line);
+		}
+	}
+
 	if (IsKeyPressed(KEY_PAGE_UP))
 	{
 		if (m_heightCutoff == 4.0f)
@@ -200,40 +208,60 @@ void MainState::Update()
 		g_pixelated = !g_pixelated;
 	}
 
-	//  Get terrain hit for highlight mesh
-	if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT))
+	//  What's under the mouse.  The ray goes through the chunk grid rather than
+	//  every visible object, so it's cheap enough to do every frame.
+	if (m_showObjects)
+	{
+		m_picker.Pick(GetMouseRay(GetMousePosition(), g_camera), m_heightCutoff);
+	}
+	else
+	{
+		m_picker.Clear();
+	}
+
+	if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT) && m_picker.GetNearest() != nullptr)
 	{
-		std::vector<shared_ptr<U7Object>>::reverse_iterator node;
+		const PickHit& hit = *m_picker.GetNearest();
+		U7Object* picked = nullptr;
 
-		for (node = m_sortedVisibleObjects.rbegin(); node != m_sortedVisibleObjects.rend(); ++node)
+		if (hit.m_kind == PickHit::TEMPLATE)
 		{
-			if (*node == nullptr || !(*node)->m_Visible)
+			//  Selecting it needs an ID, so it has to be made into a real object.
+			Vector3 pos = m_picker.GetInstance(hit).m_pos;
+			ObjectHandle id = g_chunkTemplates.Materialize(int(pos.x), int(pos.z));
+			picked = GetObjectFromID(id);
+			if (picked != nullptr)
 			{
-				continue;
+				picked->GetRecord()->m_distanceFromCamera = Vector3Distance(pos, g_camera.position);
+
+				//  Swap it into the object list so it doesn't drop out until the next update.
+				m_visibleObjects.Insert(id);
 			}
+			m_sortedVisibleTemplates.erase(remove_if(m_sortedVisibleTemplates.begin(), m_sortedVisibleTemplates.end(),
+				[&pos](const ChunkTemplateInstance& instance) { return instance.m_pos.x == pos.x && instance.m_pos.z == pos.z; }), m_sortedVisibleTemplates.end());
+		}
+		else
+		{
+			picked = g_ObjectList.Get(hit.m_handle);
+		}
 
-			bool picked = (*node)->Pick();
+		if (picked != nullptr)
+		{
+			g_selectedShape = picked->m_shapeData->GetShape();
+			g_selectedFrame = picked->m_shapeData->GetFrame();
+			m_selectedObject = picked->m_ID;
 
-			if (picked)
+			if(picked->GetIsContainer())
 			{
-				g_selectedShape = (*node)->m_shapeData->GetShape();
-				g_selectedFrame = (*node)->m_shapeData->GetFrame();
-				m_selectedObject = (*node)->m_ID;
+				AddConsoleString("Object is a container, with " + to_string(picked->GetInventory().size()) + " objects inside.");
 
-				if((*node)->m_isContainer)
+				for (auto& item : picked->GetInventory())
 				{
-					AddConsoleString("Object is a container, with " + to_string((*node)->m_inventory.size()) + " objects inside.");
-
-					for (auto& item : (*node)->m_inventory)
-					{
-						auto object = GetObjectFromID(item);
-						AddConsoleString("Item: " + g_objectTable[object->m_shapeData->m_shape].m_name + " ID: " + to_string(item));
-					}
+					auto object = GetObjectFromID(item);
+					AddConsoleString("Item: " + g_objectTable[object->m_shapeData->m_shape].m_name + " ID: " + to_string(item));
 				}
-				AddConsoleString("Selected Object: " + to_string(g_selectedShape) + " Frame: " + to_string(g_selectedFrame) + " Name: " + g_objectTable[g_selectedShape].m_name);
-
-				break;
 			}
+			AddConsoleString("Selected Object: " + to_string(g_selectedShape) + " Frame: " + to_string(g_selectedFrame) + " Name: " + g_objectTable[g_selectedShape].m_name);
 		}
 	}
 
@@ -261,11 +289,7 @@ void MainState::Draw()
 
 	if (m_showObjects)
 	{
-		for (auto& unit : m_sortedVisibleObjects)
-		{
-			unit->Draw();
-			++m_numberofDrawnUnits;
-		}
+		m_numberofDrawnUnits = DrawSortedObjects(m_visibleObjects.GetObjects(), m_sortedVisibleTemplates);
 	}
 
 	EndMode3D();
@@ -302,6 +326,18 @@ void MainState::Draw()
 	//DrawTexture(*g_Cursor, GetMouseX(), GetMouseY(), WHITE);
 
 	//  Draw any tooltips
+	const PickHit* hovered = m_picker.GetNearest();
+	if (g_Engine->m_debugDrawing && hovered != nullptr)
+	{
+		//  The object could have gone since it was picked.
+		const ObjectRecord* record = hovered->m_kind == PickHit::OBJECT ? g_ObjectList.GetRecord(hovered->m_handle) : nullptr;
+		if (hovered->m_kind == PickHit::TEMPLATE || record != nullptr)
+		{
+			int shape = record != nullptr ? record->m_shape : m_picker.GetInstance(*hovered).m_shapeData->GetShape();
+			DrawTextEx(*g_SmallFont, g_objectTable[shape].m_name.c_str(), Vector2{ GetMouseX() / ratio + 8, GetMouseY() / ratio }, g_SmallFont->baseSize, 1, WHITE);
+		}
+	}
+
 	EndTextureMode();
 	DrawTexturePro(g_guiRenderTarget.texture,
 		{ 0, 0, float(g_guiRenderTarget.texture.width), float(g_guiRenderTarget.texture.height) },
@@ -332,10 +368,7 @@ void MainState::Draw()
 
 void MainState::SetupGame()
 {
-	//  Set up map
-	int width = 3072;
-	int height = 3072;
-	g_Terrain->Init();
+	//  The terrain itself is set up by the loader.
 }
 
 //void MainState::CreateTooltip()
@@ -2,6 +2,8 @@
 #define _MainState_H_
 
 #include "Geist/State.h"
+#include "VisibleObjectSet.h"
+#include "ObjectPicker.h"
 #include <list>
 #include <deque>
 #include <array>
@@ -75,9 +77,12 @@ public:
 
    unsigned int m_terrainDrawHeight = 0;
 
-   std::vector<std::shared_ptr<U7Object>> m_sortedVisibleObjects;
+   VisibleObjectSet m_visibleObjects;
+   std::vector<ChunkTemplateInstance> m_sortedVisibleTemplates;
 
-   unsigned int m_selectedObject = 0;
+   ObjectPicker m_picker; //  What's under the mouse, picked every frame
+
+   ObjectHandle m_selectedObject = ObjectStore::INVALID_HANDLE;
 
    float m_heightCutoff = 4.0f;
 };
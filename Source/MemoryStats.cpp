@@ -0,0 +1,35 @@
+//  Deliberately does not include raylib.h; windows.h and raylib.h don't get along.
+
+#include "MemoryStats.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+unsigned long long GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#ifdef __APPLE__
+	return usage.ru_maxrss;
+#else
+	//  Linux reports kilobytes.
+	return (unsigned long long)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
@@ -0,0 +1,17 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     MEMORYSTATS.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  What the OS says about our memory use, for the benchmarks.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _MEMORYSTATS_H_
+#define _MEMORYSTATS_H_
+
+//  The most physical memory the process has had at once, in bytes, or 0 if
+//  the platform can't tell us.
+unsigned long long GetPeakResidentBytes();
+
+#endif
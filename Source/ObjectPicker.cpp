@@ -0,0 +1,63 @@
+#include "ObjectPicker.h"
+#include "U7Globals.h"
+#include <algorithm>
+
+using namespace std;
+
+void ObjectPicker::Pick(const Ray& ray, float heightCutoff)
+{
+	Clear();
+
+	//  Look as far out and as high up as either real or template objects go.
+	int margin = g_chunkObjectMap.GetChunkMargin();
+	float top = g_chunkObjectMap.GetMaxTop();
+	bool templates = g_chunkTemplates.IsBuilt();
+	if (templates)
+	{
+		margin = max(margin, (ChunkTemplates::MAX_REACH + ChunkObjectMap::CHUNK_SIZE - 1) / ChunkObjectMap::CHUNK_SIZE);
+		top = max(top, float(ChunkTemplates::MAX_HEIGHT));
+	}
+
+	g_chunkObjectMap.ForEachChunkAlongRay(ray, margin, top, [this, &ray, heightCutoff, templates](int chunkx, int chunkz)
+		{
+			for (ObjectHandle handle : g_chunkObjectMap.GetChunk(chunkx, chunkz))
+			{
+				const ObjectRecord* record = g_ObjectList.GetRecord(handle);
+				if (!record->IsDrawn() || record->m_pos.y > heightCutoff)
+				{
+					continue;
+				}
+
+				++m_considered;
+				RayCollision collision = GetRayCollisionBox(ray, record->m_boundingBox);
+				if (collision.hit)
+				{
+					m_hits.push_back({ PickHit::OBJECT, handle, -1, collision.distance });
+				}
+			}
+
+			if (templates)
+			{
+				float chunkLeft = float(chunkx * ChunkObjectMap::CHUNK_SIZE);
+				float chunkTop = float(chunkz * ChunkObjectMap::CHUNK_SIZE);
+				m_instances.clear();
+				g_chunkTemplates.GetInstancesInRect(chunkLeft, chunkTop, chunkLeft + ChunkObjectMap::CHUNK_SIZE - 1, chunkTop + ChunkObjectMap::CHUNK_SIZE - 1, m_instances);
+
+				for (const ChunkTemplateInstance& instance : m_instances)
+				{
+					++m_considered;
+					RayCollision collision = GetRayCollisionBox(ray, instance.GetBoundingBox());
+					if (collision.hit)
+					{
+						m_hits.push_back({ PickHit::TEMPLATE, ObjectStore::INVALID_HANDLE, int(m_hitInstances.size()), collision.distance });
+						m_hitInstances.push_back(instance);
+					}
+				}
+			}
+
+			return true;
+		});
+
+	//  The chunks come roughly in order, so this has little to do.
+	sort(m_hits.begin(), m_hits.end(), [](const PickHit& a, const PickHit& b) { return a.m_distance < b.m_distance; });
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     OBJECTPICKER.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  What's under a ray, usually the one from the mouse.  The ray
+//           is walked through the chunk grid front to back, and only the
+//           objects and chunk template objects in the chunks it crosses
+//           are tested against it, so picking costs the same however
+//           much is on screen and can be done every frame for hovering.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _OBJECTPICKER_H_
+#define _OBJECTPICKER_H_
+
+#include "raylib.h"
+#include "ObjectStore.h"
+#include "ChunkTemplates.h"
+#include <vector>
+
+//  Something the ray went through: a real object, or a chunk template object.
+struct PickHit
+{
+	enum Kind
+	{
+		OBJECT,
+		TEMPLATE
+	};
+
+	Kind m_kind;
+	ObjectHandle m_handle; //  OBJECT only
+	int m_instance; //  TEMPLATE only: read it with ObjectPicker::GetInstance()
+	float m_distance;
+};
+
+class ObjectPicker
+{
+public:
+	//  Finds everything drawn at or below heightCutoff whose box the ray goes
+	//  through.
+	void Pick(const Ray& ray, float heightCutoff);
+
+	void Clear() { m_hits.clear(); m_hitInstances.clear(); m_considered = 0; }
+
+	//  Nearest along the ray first.
+	const std::vector<PickHit>& GetHits() const { return m_hits; }
+
+	//  nullptr if the ray didn't hit anything.
+	const PickHit* GetNearest() const { return m_hits.empty() ? nullptr : &m_hits[0]; }
+
+	//  The chunk template objects that were hit, for TEMPLATE hits.
+	const ChunkTemplateInstance& GetInstance(const PickHit& hit) const { return m_hitInstances[hit.m_instance]; }
+
+	//  How many boxes the last Pick() tested.
+	size_t GetConsidered() const { return m_considered; }
+
+private:
+	std::vector<PickHit> m_hits;
+	std::vector<ChunkTemplateInstance> m_hitInstances;
+	std::vector<ChunkTemplateInstance> m_instances; //  Kept so picking every frame doesn't allocate
+	size_t m_considered = 0;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "Geist/Logging.h"
+#include "ObjectPool.h"
+#include "U7Object.h"
+#include <new>
+
+using namespace std;
+
+ObjectPool::ObjectPool()
+{
+	m_arenas.resize(1);
+	m_arenas[WORLD_ARENA].m_active = true;
+}
+
+ObjectPool::~ObjectPool()
+{
+	Clear();
+	for (char* block : m_spareBlocks)
+	{
+		::operator delete(block);
+	}
+	m_spareBlocks.clear();
+}
+
+char* ObjectPool::GetBlock()
+{
+	if (!m_spareBlocks.empty())
+	{
+		char* block = m_spareBlocks.back();
+		m_spareBlocks.pop_back();
+		return block;
+	}
+
+	++m_blockAllocations;
+	return static_cast<char*>(::operator new(sizeof(U7Object) * BLOCK_OBJECTS));
+}
+
+U7Object* ObjectPool::Allocate(int arena)
+{
+	Arena& thisArena = m_arenas[arena];
+
+	void* memory;
+	if (!thisArena.m_freeObjects.empty())
+	{
+		memory = thisArena.m_freeObjects.back();
+		thisArena.m_freeObjects.pop_back();
+	}
+	else
+	{
+		if (thisArena.m_usedInLastBlock == BLOCK_OBJECTS)
+		{
+			thisArena.m_blocks.push_back(GetBlock());
+			thisArena.m_usedInLastBlock = 0;
+		}
+
+		memory = thisArena.m_blocks.back() + sizeof(U7Object) * thisArena.m_usedInLastBlock;
+		++thisArena.m_usedInLastBlock;
+	}
+
+	++thisArena.m_liveObjects;
+	return new (memory) U7Object();
+}
+
+void ObjectPool::Free(U7Object* object, int arena)
+{
+	object->~U7Object();
+
+	Arena& thisArena = m_arenas[arena];
+	thisArena.m_freeObjects.push_back(object);
+	--thisArena.m_liveObjects;
+}
+
+int ObjectPool::CreateArena()
+{
+	int arena;
+	if (!m_freeArenas.empty())
+	{
+		arena = m_freeArenas.back();
+		m_freeArenas.pop_back();
+	}
+	else
+	{
+		arena = int(m_arenas.size());
+		m_arenas.emplace_back();
+	}
+
+	m_arenas[arena].m_active = true;
+	return arena;
+}
+
+void ObjectPool::ReleaseArena(int arena)
+{
+	Arena& thisArena = m_arenas[arena];
+	if (thisArena.m_liveObjects != 0)
+	{
+		Log("Releasing an object arena with " + to_string(thisArena.m_liveObjects) + " objects still in it.", LOG_ERROR);
+		return;
+	}
+
+	m_spareBlocks.insert(m_spareBlocks.end(), thisArena.m_blocks.begin(), thisArena.m_blocks.end());
+	thisArena = Arena();
+
+	//  The world arena is never given out again, just emptied.
+	if (arena == WORLD_ARENA)
+	{
+		thisArena.m_active = true;
+	}
+	else
+	{
+		m_freeArenas.push_back(arena);
+	}
+}
+
+void ObjectPool::Clear()
+{
+	for (size_t i = 0; i < m_arenas.size(); ++i)
+	{
+		m_spareBlocks.insert(m_spareBlocks.end(), m_arenas[i].m_blocks.begin(), m_arenas[i].m_blocks.end());
+	}
+
+	m_arenas.clear();
+	m_freeArenas.clear();
+	m_arenas.resize(1);
+	m_arenas[WORLD_ARENA].m_active = true;
+}
+
+ObjectPool::Stats ObjectPool::GetStats() const
+{
+	Stats stats;
+	size_t capacity = 0;
+	for (auto& arena : m_arenas)
+	{
+		if (!arena.m_active)
+		{
+			continue;
+		}
+
+		++stats.m_arenas;
+		stats.m_liveObjects += arena.m_liveObjects;
+		stats.m_blocks += arena.m_blocks.size();
+		capacity += arena.m_blocks.size() * BLOCK_OBJECTS;
+	}
+
+	stats.m_spareBlocks = m_spareBlocks.size();
+	stats.m_bytesReserved = (stats.m_blocks + stats.m_spareBlocks) * BLOCK_OBJECTS * sizeof(U7Object);
+	stats.m_bytesUsed = stats.m_liveObjects * sizeof(U7Object);
+	stats.m_fragmentation = capacity > 0 ? 1.0f - float(stats.m_liveObjects) / float(capacity) : 0;
+	stats.m_blockAllocations = m_blockAllocations;
+	return stats;
+}
+
+vector<string> ObjectPool::GetStatsText() const
+{
+	Stats stats = GetStats();
+
+	vector<string> text;
+	text.push_back("Objects: " + to_string(stats.m_liveObjects) + " live, " + to_string(sizeof(U7Object)) + " bytes each, "
+		+ to_string(stats.m_arenas) + " arenas.");
+	text.push_back("Object memory: " + to_string(stats.m_bytesUsed / 1024) + " KB used of " + to_string(stats.m_bytesReserved / 1024) + " KB reserved.");
+	text.push_back("Object blocks: " + to_string(stats.m_blocks) + " in use, " + to_string(stats.m_spareBlocks) + " spare, "
+		+ to_string(stats.m_blockAllocations) + " ever allocated, " + to_string(int(stats.m_fragmentation * 100 + .5f)) + " percent of the space in use is holes.");
+	return text;
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     OBJECTPOOL.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Where the U7Objects themselves live.  Objects are carved out
+//           of blocks of BLOCK_OBJECTS at a time instead of each being
+//           its own heap allocation, so loading the world is a few
+//           hundred allocations instead of a few hundred thousand, and
+//           objects created together sit together in memory.
+//
+//           Blocks belong to arenas.  Arena 0 is the world; the superchunk
+//           streamer gives each superchunk its own, so when the superchunk
+//           goes away its blocks go back to the spare list in one go.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _OBJECTPOOL_H_
+#define _OBJECTPOOL_H_
+
+#include <string>
+#include <vector>
+
+class U7Object;
+
+class ObjectPool
+{
+public:
+	static const int BLOCK_OBJECTS = 512;
+	static const int WORLD_ARENA = 0;
+
+	ObjectPool();
+	~ObjectPool();
+
+	//  Constructs a U7Object in the arena.
+	U7Object* Allocate(int arena);
+
+	//  Destroys an object from Allocate().  arena has to be the one it came from.
+	void Free(U7Object* object, int arena);
+
+	int CreateArena();
+
+	//  Hands the arena's blocks back for other arenas to use.  Everything in it
+	//  has to have been freed first; if it hasn't, the arena is kept.
+	void ReleaseArena(int arena);
+
+	//  Destroys nothing; only for after every object has been freed.
+	void Clear();
+
+	struct Stats
+	{
+		size_t m_liveObjects = 0;
+		size_t m_blocks = 0;          //  In use by arenas.
+		size_t m_spareBlocks = 0;
+		size_t m_arenas = 0;
+		size_t m_bytesReserved = 0;   //  All blocks, spare ones included.
+		size_t m_bytesUsed = 0;       //  Live objects.
+		float m_fragmentation = 0;    //  How much of the arenas' blocks is holes, 0 to 1.
+		size_t m_blockAllocations = 0; //  Heap allocations ever made for blocks.
+	};
+
+	Stats GetStats() const;
+
+	//  The stats as a few lines of text, for the log or the console.
+	std::vector<std::string> GetStatsText() const;
+
+private:
+	struct Arena
+	{
+		std::vector<char*> m_blocks;
+		std::vector<U7Object*> m_freeObjects;
+		int m_usedInLastBlock = BLOCK_OBJECTS;
+		size_t m_liveObjects = 0;
+		bool m_active = false;
+	};
+
+	char* GetBlock();
+
+	std::vector<Arena> m_arenas;
+	std::vector<int> m_freeArenas;
+	std::vector<char*> m_spareBlocks;
+	size_t m_blockAllocations = 0;
+};
+
+#endif
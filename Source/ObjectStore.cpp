@@ -0,0 +1,132 @@
+#include "Geist/Logging.h"
+#include "ObjectStore.h"
+#include "U7Object.h"
+#include <algorithm>
+
+using namespace std;
+
+ObjectStore::~ObjectStore()
+{
+	Clear();
+}
+
+ObjectHandle ObjectStore::Allocate()
+{
+	uint32_t index;
+	if (!m_freeSlots.empty())
+	{
+		index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else if (m_slots.size() < MAX_OBJECTS)
+	{
+		index = uint32_t(m_slots.size());
+		m_slots.emplace_back();
+		m_records.emplace_back();
+	}
+	else
+	{
+		Log("Object store is full.", LOG_ERROR);
+		return INVALID_HANDLE;
+	}
+
+	m_slots[index].m_allocated = true;
+	m_records[index] = ObjectRecord();
+	return MakeHandle(index);
+}
+
+U7Object* ObjectStore::Create(ObjectHandle handle)
+{
+	uint32_t index = handle & INDEX_MASK;
+	if (index >= m_slots.size() || m_slots[index].m_generation != (handle >> INDEX_BITS) || !m_slots[index].m_allocated)
+	{
+		Log("Creating an object with a bad handle.", LOG_ERROR);
+		return nullptr;
+	}
+
+	Slot& slot = m_slots[index];
+	if (slot.m_object != nullptr)
+	{
+		m_pool.Free(slot.m_object, slot.m_arena);
+		--m_count;
+	}
+
+	m_records[index] = ObjectRecord();
+	slot.m_object = m_pool.Allocate(m_arena);
+	slot.m_arena = uint16_t(m_arena);
+	++m_count;
+	return slot.m_object;
+}
+
+void ObjectStore::Remove(ObjectHandle handle)
+{
+	uint32_t index = handle & INDEX_MASK;
+	if (index >= m_slots.size() || m_slots[index].m_generation != (handle >> INDEX_BITS) || !m_slots[index].m_allocated)
+	{
+		return;
+	}
+
+	Slot& slot = m_slots[index];
+	if (slot.m_object != nullptr)
+	{
+		m_pool.Free(slot.m_object, slot.m_arena);
+		slot.m_object = nullptr;
+		--m_count;
+	}
+	slot.m_allocated = false;
+
+	//  Generation 0 is skipped so no handle is ever 0.
+	slot.m_generation = (slot.m_generation == GENERATION_MASK) ? 1 : slot.m_generation + 1;
+
+	m_freeSlots.push_back(index);
+}
+
+void ObjectStore::Clear()
+{
+	for (auto& slot : m_slots)
+	{
+		if (slot.m_object != nullptr)
+		{
+			m_pool.Free(slot.m_object, slot.m_arena);
+		}
+	}
+	m_pool.Clear();
+	m_arena = ObjectPool::WORLD_ARENA;
+
+	m_slots.clear();
+	m_records.clear();
+	m_freeSlots.clear();
+	m_count = 0;
+}
+
+void ObjectStore::Reserve(size_t count)
+{
+	m_slots.reserve(min(count, size_t(MAX_OBJECTS)));
+	m_records.reserve(min(count, size_t(MAX_OBJECTS)));
+}
+
+vector<string> ObjectStore::GetStatsText() const
+{
+	size_t coldObjects = 0;
+	for (U7Object* object : *this)
+	{
+		if (object->HasColdData())
+		{
+			++coldObjects;
+		}
+	}
+
+	size_t slotBytes = m_slots.capacity() * sizeof(Slot);
+	size_t recordBytes = m_records.capacity() * sizeof(ObjectRecord);
+	size_t coldBytes = coldObjects * sizeof(U7ObjectColdData);
+
+	vector<string> text;
+	text.push_back("Object records: " + to_string(m_count) + " live, " + to_string(sizeof(ObjectRecord)) + " bytes each, "
+		+ to_string(recordBytes / 1024) + " KB for " + to_string(m_records.capacity()) + " slots, plus " + to_string(slotBytes / 1024) + " KB of handles.");
+	text.push_back("Object cold data: " + to_string(coldObjects) + " objects, " + to_string(sizeof(U7ObjectColdData)) + " bytes each, "
+		+ to_string(coldBytes / 1024) + " KB.");
+
+	vector<string> poolText = m_pool.GetStatsText();
+	text.insert(text.end(), poolText.begin(), poolText.end());
+	return text;
+}
@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     OBJECTSTORE.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Every object in the world, in one array of slots.  An object
+//           is found by a 32-bit handle: the low 20 bits are its slot and
+//           the next 11 are the slot's generation, which goes up each
+//           time the slot is emptied.  A handle to a deleted object
+//           stops working instead of finding whatever got the slot next.
+//
+//           Looking an object up is an index and a compare; no hashing,
+//           and no reference counts to bump.  Going through the store
+//           visits the slots in order, so it's the same every run.
+//
+//           Handles are what the rest of the game calls object IDs.  The
+//           top bit is never used so they still fit in an int, and no
+//           handle is ever 0.
+//
+//           The objects themselves come out of an ObjectPool.  New objects
+//           go in whichever arena SetArena() last picked.
+//
+//           Next to each slot is the object's ObjectRecord: the little bit
+//           of it that finding, sorting and picking visible objects needs,
+//           packed into one array so those loops never touch the objects.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _OBJECTSTORE_H_
+#define _OBJECTSTORE_H_
+
+#include "raylib.h"
+#include "ObjectPool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class U7Object;
+
+typedef uint32_t ObjectHandle;
+
+struct ObjectRecord
+{
+	enum Flags
+	{
+		VISIBLE = 1,
+		CONTAINER = 2,
+		CONTAINED = 4,
+		EGG = 8,
+		IN_CHUNK_MAP = 16 //  Filed in g_chunkObjectMap
+	};
+
+	Vector3 m_pos{ 0, 0, 0 };
+	BoundingBox m_boundingBox{ { 0, 0, 0 }, { 0, 0, 0 } };
+	float m_distanceFromCamera = 0;
+	uint16_t m_shape = 0;
+	uint8_t m_frame = 0;
+	uint8_t m_flags = VISIBLE;
+
+	bool GetFlag(Flags flag) const { return (m_flags & flag) != 0; }
+	void SetFlag(Flags flag, bool value) { m_flags = value ? (m_flags | flag) : (m_flags & ~flag); }
+
+	//  Whether it's something that gets drawn in the world at all.
+	bool IsDrawn() const { return (m_flags & (VISIBLE | CONTAINED | EGG)) == VISIBLE; }
+};
+
+class ObjectStore
+{
+public:
+	static const int INDEX_BITS = 20;
+	static const int GENERATION_BITS = 11;
+	static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+	static const uint32_t GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+	static const uint32_t MAX_OBJECTS = 1u << INDEX_BITS;
+	static const ObjectHandle INVALID_HANDLE = 0;
+
+	ObjectStore() {};
+	~ObjectStore();
+
+	//  Hands out a slot for an object that will be Create()d later, so IDs
+	//  can be given out before the objects exist.  Returns INVALID_HANDLE if
+	//  the store is full.
+	ObjectHandle Allocate();
+
+	//  Makes a new, un-Init()ed object in a slot from Allocate().
+	U7Object* Create(ObjectHandle handle);
+
+	//  Deletes the object and frees its slot.  Stale handles are ignored.
+	void Remove(ObjectHandle handle);
+
+	void Clear();
+	void Reserve(size_t count);
+
+	//  The arena objects are created in from now on.  The superchunk streamer
+	//  switches to a superchunk's own arena while it makes its objects.
+	void SetArena(int arena) { m_arena = arena; }
+	int GetArena() const { return m_arena; }
+	ObjectPool& GetPool() { return m_pool; }
+	const ObjectPool& GetPool() const { return m_pool; }
+
+	//  nullptr if the object's been removed, or was never created.
+	inline U7Object* Get(ObjectHandle handle) const
+	{
+		uint32_t index = handle & INDEX_MASK;
+		if (index >= m_slots.size() || m_slots[index].m_generation != (handle >> INDEX_BITS))
+		{
+			return nullptr;
+		}
+		return m_slots[index].m_object;
+	}
+
+	//  The same, for the record.  Works between Allocate() and Create() too.
+	inline ObjectRecord* GetRecord(ObjectHandle handle)
+	{
+		uint32_t index = handle & INDEX_MASK;
+		if (index >= m_slots.size() || m_slots[index].m_generation != (handle >> INDEX_BITS))
+		{
+			return nullptr;
+		}
+		return &m_records[index];
+	}
+
+	inline const ObjectRecord* GetRecord(ObjectHandle handle) const
+	{
+		return const_cast<ObjectStore*>(this)->GetRecord(handle);
+	}
+
+	//  Live objects.
+	size_t size() const { return m_count; }
+
+	//  How much memory the objects take, as a few lines of text.
+	std::vector<std::string> GetStatsText() const;
+
+	//  Goes through the live objects in slot order.
+	class iterator
+	{
+	public:
+		iterator(const ObjectStore* store, size_t index) : m_store(store), m_index(index) { SkipEmpty(); }
+
+		U7Object* operator*() const { return m_store->m_slots[m_index].m_object; }
+		iterator& operator++() { ++m_index; SkipEmpty(); return *this; }
+		bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+
+		ObjectHandle GetHandle() const { return m_store->MakeHandle(uint32_t(m_index)); }
+		ObjectRecord& GetRecord() const { return const_cast<ObjectStore*>(m_store)->m_records[m_index]; }
+
+	private:
+		void SkipEmpty()
+		{
+			while (m_index < m_store->m_slots.size() && m_store->m_slots[m_index].m_object == nullptr)
+			{
+				++m_index;
+			}
+		}
+
+		const ObjectStore* m_store;
+		size_t m_index;
+	};
+
+	iterator begin() const { return iterator(this, 0); }
+	iterator end() const { return iterator(this, m_slots.size()); }
+
+private:
+	struct Slot
+	{
+		U7Object* m_object = nullptr;
+		uint32_t m_generation = 1;
+		uint16_t m_arena = 0;
+		bool m_allocated = false;
+	};
+
+	ObjectHandle MakeHandle(uint32_t index) const { return (m_slots[index].m_generation << INDEX_BITS) | index; }
+
+	std::vector<Slot> m_slots;
+	std::vector<ObjectRecord> m_records;
+	std::vector<uint32_t> m_freeSlots;
+	size_t m_count = 0;
+	ObjectPool m_pool;
+	int m_arena = ObjectPool::WORLD_ARENA;
+};
+
+#endif
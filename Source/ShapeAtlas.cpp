@@ -0,0 +1,197 @@
+#include "ShapeAtlas.h"
+#include "Geist/Logging.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+ShapeAtlas::~ShapeAtlas()
+{
+	Unload();
+}
+
+//  Copies an image into a page, along with a border of its own edge pixels.
+static void CopyWithBorder(const Image& image, Image& page, int x, int y, int bytesPerPixel)
+{
+	unsigned char* dest = (unsigned char*)page.data;
+	const unsigned char* src = (const unsigned char*)image.data;
+	int sourceStride = image.width * bytesPerPixel;
+	int destStride = page.width * bytesPerPixel;
+
+	for (int row = -ShapeAtlas::PADDING; row < image.height + ShapeAtlas::PADDING; ++row)
+	{
+		const unsigned char* sourceRow = src + std::min(std::max(row, 0), image.height - 1) * sourceStride;
+		unsigned char* destRow = dest + (y + row) * destStride + x * bytesPerPixel;
+
+		for (int i = 1; i <= ShapeAtlas::PADDING; ++i)
+		{
+			memcpy(destRow - i * bytesPerPixel, sourceRow, bytesPerPixel);
+			memcpy(destRow + (image.width + i - 1) * bytesPerPixel, sourceRow + sourceStride - bytesPerPixel, bytesPerPixel);
+		}
+		memcpy(destRow, sourceRow, sourceStride);
+	}
+}
+
+void ShapeAtlas::Pack(const std::vector<Image>& images)
+{
+	Unload();
+	m_rects.assign(images.size(), AtlasRect());
+
+	int format = 0;
+	for (auto& image : images)
+	{
+		if (image.data != nullptr)
+		{
+			format = image.format;
+			break;
+		}
+	}
+
+	int bytesPerPixel = GetPixelDataSize(1, 1, format);
+
+	//  Indexed pages start out transparent the same way indexed frames do.
+	unsigned char clearValue = (format == PIXELFORMAT_UNCOMPRESSED_GRAYSCALE) ? 255 : 0;
+
+	//  Tallest first keeps the shelves tight.
+	std::vector<int> order;
+	order.reserve(images.size());
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		const Image& image = images[i];
+		if (image.data == nullptr || image.format != format || image.width <= 0 || image.height <= 0
+			|| image.width + PADDING * 2 > PAGE_SIZE || image.height + PADDING * 2 > PAGE_SIZE)
+		{
+			continue;
+		}
+		order.push_back(int(i));
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&images](int a, int b) { return images[a].height > images[b].height; });
+
+	//  First just work out where everything goes, so the last page can be cut
+	//  down to what it actually uses.
+	std::vector<int> pageHeights;
+	int shelfX = 0;
+	int shelfY = 0;
+	int shelfHeight = 0;
+	for (int index : order)
+	{
+		int width = images[index].width + PADDING * 2;
+		int height = images[index].height + PADDING * 2;
+
+		if (shelfX + width > PAGE_SIZE)
+		{
+			shelfX = 0;
+			shelfY += shelfHeight;
+			shelfHeight = 0;
+		}
+
+		if (pageHeights.empty() || shelfY + height > PAGE_SIZE)
+		{
+			pageHeights.push_back(0);
+			m_usedPixels.push_back(0);
+			m_imageCounts.push_back(0);
+			shelfX = 0;
+			shelfY = 0;
+			shelfHeight = 0;
+		}
+
+		AtlasRect& rect = m_rects[index];
+		rect.m_page = int(pageHeights.size()) - 1;
+		rect.m_source = Rectangle{ float(shelfX + PADDING), float(shelfY + PADDING), float(images[index].width), float(images[index].height) };
+
+		shelfX += width;
+		shelfHeight = std::max(shelfHeight, height);
+		pageHeights.back() = std::max(pageHeights.back(), shelfY + height);
+		m_usedPixels.back() += images[index].width * images[index].height;
+		++m_imageCounts.back();
+	}
+
+	for (int& height : pageHeights)
+	{
+		int pageHeight = 1;
+		while (pageHeight < height)
+		{
+			pageHeight *= 2;
+		}
+		height = pageHeight;
+
+		Image page;
+		page.width = PAGE_SIZE;
+		page.height = height;
+		page.mipmaps = 1;
+		page.format = format;
+		page.data = malloc(size_t(PAGE_SIZE) * height * bytesPerPixel);
+		memset(page.data, clearValue, size_t(PAGE_SIZE) * height * bytesPerPixel);
+		m_pages.push_back(page);
+	}
+
+	for (int index : order)
+	{
+		AtlasRect& rect = m_rects[index];
+		Image& page = m_pages[rect.m_page];
+		CopyWithBorder(images[index], page, int(rect.m_source.x), int(rect.m_source.y), bytesPerPixel);
+
+		rect.m_uv = Rectangle{ rect.m_source.x / page.width, rect.m_source.y / page.height,
+			rect.m_source.width / page.width, rect.m_source.height / page.height };
+	}
+}
+
+void ShapeAtlas::Upload()
+{
+	for (auto& page : m_pages)
+	{
+		Texture texture = LoadTextureFromImage(page);
+		SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+		SetTextureWrap(texture, TEXTURE_WRAP_CLAMP);
+		m_textures.push_back(texture);
+
+		free(page.data);
+		page.data = nullptr;
+	}
+}
+
+void ShapeAtlas::Unload()
+{
+	for (auto& texture : m_textures)
+	{
+		UnloadTexture(texture);
+	}
+	m_textures.clear();
+
+	for (auto& page : m_pages)
+	{
+		free(page.data);
+	}
+	m_pages.clear();
+
+	m_rects.clear();
+	m_usedPixels.clear();
+	m_imageCounts.clear();
+}
+
+float ShapeAtlas::GetPageFill(int page) const
+{
+	return float(m_usedPixels[page]) / (float(m_pages[page].width) * float(m_pages[page].height));
+}
+
+void ShapeAtlas::LogStats() const
+{
+	int packed = 0;
+	for (auto& rect : m_rects)
+	{
+		if (rect.m_page >= 0)
+		{
+			++packed;
+		}
+	}
+
+	Log("Shape atlas: " + to_string(packed) + " of " + to_string(m_rects.size()) + " images on " + to_string(m_pages.size()) + " pages.");
+	for (size_t i = 0; i < m_pages.size(); ++i)
+	{
+		Log("  Page " + to_string(i) + ": " + to_string(m_pages[i].width) + "x" + to_string(m_pages[i].height) + ", "
+			+ to_string(m_imageCounts[i]) + " images, " + to_string(int(GetPageFill(int(i)) * 100 + .5f)) + " percent full.");
+	}
+}
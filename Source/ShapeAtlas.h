@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     SHAPEATLAS.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Packs the object shape frames into a few big textures so
+//           drawing a screenful of objects doesn't bind a different
+//           texture for every one.  Each packed image gets a page and a
+//           rectangle, both in pixels (for billboards) and in UVs (for
+//           meshes).
+//
+//           Images are shelf-packed tallest first, with a one pixel border
+//           copied from their edges so nothing bleeds in from the
+//           neighbours.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _SHAPEATLAS_H_
+#define _SHAPEATLAS_H_
+
+#include "raylib.h"
+#include <vector>
+
+//  Where one image ended up.
+struct AtlasRect
+{
+	int m_page = -1;          //  -1 if it didn't go in the atlas.
+	Rectangle m_source{ 0, 0, 0, 0 };  //  In pixels.
+	Rectangle m_uv{ 0, 0, 1, 1 };      //  0 to 1.
+};
+
+class ShapeAtlas
+{
+public:
+	static const int PAGE_SIZE = 2048;
+	static const int PADDING = 1;
+
+	ShapeAtlas() {};
+	~ShapeAtlas();
+
+	//  Packs copies of the images into pages.  Only reads the images, so it can
+	//  run on a worker thread.  Every image has to be in the same format;
+	//  anything that isn't, or won't fit on a page, is left out.
+	void Pack(const std::vector<Image>& images);
+
+	//  Makes textures out of the pages and drops the CPU copies.  Main thread only.
+	void Upload();
+	void Unload();
+
+	//  One for each image handed to Pack(), in the same order.
+	const AtlasRect& GetRect(int index) const { return m_rects[index]; }
+
+	int GetPageCount() const { return int(m_pages.size()); }
+	const Texture& GetPageTexture(int page) const { return m_textures[page]; }
+
+	//  Only until Upload().
+	const Image& GetPageImage(int page) const { return m_pages[page]; }
+
+	//  How much of the page is covered by images, 0 to 1.
+	float GetPageFill(int page) const;
+
+	void LogStats() const;
+
+private:
+	std::vector<AtlasRect> m_rects;
+	std::vector<Image> m_pages;
+	std::vector<Texture> m_textures;
+	std::vector<long long> m_usedPixels;
+	std::vector<int> m_imageCounts;
+};
+
+#endif
@@ -15,9 +15,34 @@
 #include "Geist/Engine.h"
 #include "U7Globals.h"
 #include "ShapeData.h"
+#include "ShapeTableFile.h"
 
 using namespace std;
 
+//  GenMeshPlane() with a resolution of one gives four vertices with the UVs
+//  (0, 0), (1, 0), (0, 1) and (1, 1), in that order.  This maps them onto uv.
+static void SetPlaneTexcoords(Mesh& mesh, Rectangle uv, bool flipU, bool flipV)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		float u = float(i & 1);
+		float v = float(i >> 1);
+		if (flipU)
+		{
+			u = 1 - u;
+		}
+		if (flipV)
+		{
+			v = 1 - v;
+		}
+
+		mesh.texcoords[i * 2] = uv.x + u * uv.width;
+		mesh.texcoords[i * 2 + 1] = uv.y + v * uv.height;
+	}
+
+	UpdateMeshBuffer(mesh, 1, mesh.texcoords, sizeof(float) * mesh.vertexCount * 2, 0);
+}
+
 ShapeData::ShapeData()
 {
 	m_isValid = false;
@@ -130,100 +155,76 @@ void ShapeData::SetupTextures()
 
 }
 
-void ShapeData::Serialize(ofstream& outStream)
+void ShapeData::Serialize(ShapeTableRecord& record) const
 {
-	outStream << m_shape << " ";
-	outStream << m_frame << " ";
-	outStream << m_topTextureOffsetX << " ";
-	outStream << m_topTextureOffsetY << " ";
-	outStream << m_topTextureWidth << " ";
-	outStream << m_topTextureHeight << " ";
-	outStream << m_frontTextureOffsetX << " ";
-	outStream << m_frontTextureOffsetY << " ";
-	outStream << m_frontTextureWidth << " ";
-	outStream << m_frontTextureHeight << " ";
-	outStream << m_rightTextureOffsetX << " ";
-	outStream << m_rightTextureOffsetY << " ";
-	outStream << m_rightTextureWidth << " ";
-	outStream << m_rightTextureHeight << " ";
-	outStream << static_cast<int>(m_drawType) << " ";
-	outStream << m_Scaling.x << " ";
-	outStream << m_Scaling.y << " ";
-	outStream << m_Scaling.z << " ";
-	outStream << m_TweakPos.x << " ";
-	outStream << m_TweakPos.y << " ";
-	outStream << m_TweakPos.z << " ";
-	outStream << m_rotation << " ";
-	outStream << static_cast<int>(m_sideTextures[0]) << " ";
-	outStream << static_cast<int>(m_sideTextures[1]) << " ";
-	outStream << static_cast<int>(m_sideTextures[2]) << " ";
-	outStream << static_cast<int>(m_sideTextures[3]) << " ";
-	outStream << static_cast<int>(m_sideTextures[4]) << " ";
-	outStream << static_cast<int>(m_sideTextures[5]) << " ";
-	outStream << m_customMeshName << " ";
-	outStream << m_meshOutline << " ";
-	outStream << m_useShapePointer << " ";
-	outStream << m_pointerShape << " ";
-	outStream << m_pointerFrame << " ";
-	outStream << endl;
-
-	outStream.flush();
+	record.m_shape = m_shape;
+	record.m_frame = m_frame;
+	record.m_textureRects[0] = m_topTextureOffsetX;
+	record.m_textureRects[1] = m_topTextureOffsetY;
+	record.m_textureRects[2] = m_topTextureWidth;
+	record.m_textureRects[3] = m_topTextureHeight;
+	record.m_textureRects[4] = m_frontTextureOffsetX;
+	record.m_textureRects[5] = m_frontTextureOffsetY;
+	record.m_textureRects[6] = m_frontTextureWidth;
+	record.m_textureRects[7] = m_frontTextureHeight;
+	record.m_textureRects[8] = m_rightTextureOffsetX;
+	record.m_textureRects[9] = m_rightTextureOffsetY;
+	record.m_textureRects[10] = m_rightTextureWidth;
+	record.m_textureRects[11] = m_rightTextureHeight;
+	record.m_drawType = static_cast<int>(m_drawType);
+	record.m_scaling[0] = m_Scaling.x;
+	record.m_scaling[1] = m_Scaling.y;
+	record.m_scaling[2] = m_Scaling.z;
+	record.m_tweakPos[0] = m_TweakPos.x;
+	record.m_tweakPos[1] = m_TweakPos.y;
+	record.m_tweakPos[2] = m_TweakPos.z;
+	record.m_rotation = m_rotation;
+	for (int i = 0; i < 6; ++i)
+	{
+		record.m_sideTextures[i] = static_cast<int>(m_sideTextures[i]);
+	}
+	record.m_meshOutline = m_meshOutline;
+	record.m_useShapePointer = m_useShapePointer;
+	record.m_pointerShape = m_pointerShape;
+	record.m_pointerFrame = m_pointerFrame;
+	record.m_unused1 = 0;
+	record.m_unused2[0] = 0;
+	record.m_unused2[1] = 0;
 }
 
-void ShapeData::Deserialize(ifstream& inStream)
+void ShapeData::Deserialize(const ShapeTableRecord& record, const std::string& customMeshName)
 {
-	inStream >> m_shape;
-	inStream >> m_frame;
-	inStream >> m_topTextureOffsetX;
-	inStream >> m_topTextureOffsetY;
-	inStream >> m_topTextureWidth;
-	inStream >> m_topTextureHeight;
-	inStream >> m_frontTextureOffsetX;
-	inStream >> m_frontTextureOffsetY;
-	inStream >> m_frontTextureWidth;
-	inStream >> m_frontTextureHeight;
-	inStream >> m_rightTextureOffsetX;
-	inStream >> m_rightTextureOffsetY;
-	inStream >> m_rightTextureWidth;
-	inStream >> m_rightTextureHeight;
-	int drawType;
-	inStream >> drawType;
-	m_drawType = static_cast<ShapeDrawType>(drawType);
-	inStream >> m_Scaling.x;
-	inStream >> m_Scaling.y;
-	inStream >> m_Scaling.z;
-	inStream >> m_TweakPos.x;
-	inStream >> m_TweakPos.y;
-	inStream >> m_TweakPos.z;
-	inStream >> m_rotation;
-	int sideTexture;
-	inStream >> sideTexture;
-	m_sideTextures[0] = static_cast<CuboidTexture>(sideTexture);
-	inStream >> sideTexture;
-	m_sideTextures[1] = static_cast<CuboidTexture>(sideTexture);
-	inStream >> sideTexture;
-	m_sideTextures[2] = static_cast<CuboidTexture>(sideTexture);
-	inStream >> sideTexture;
-	m_sideTextures[3] = static_cast<CuboidTexture>(sideTexture);
-	inStream >> sideTexture;
-	m_sideTextures[4] = static_cast<CuboidTexture>(sideTexture);
-	inStream >> sideTexture;
-	m_sideTextures[5] = static_cast<CuboidTexture>(sideTexture);
-
-	if (m_shape == 191)
-	{
-		int stopper = 0;
-	}
-
-	inStream >> m_customMeshName;
-	inStream >> m_meshOutline;
-
-	inStream >>  m_useShapePointer;
-	inStream >> m_pointerShape;
-	inStream >> m_pointerFrame;
+	m_shape = record.m_shape;
+	m_frame = record.m_frame;
+	m_topTextureOffsetX = record.m_textureRects[0];
+	m_topTextureOffsetY = record.m_textureRects[1];
+	m_topTextureWidth = record.m_textureRects[2];
+	m_topTextureHeight = record.m_textureRects[3];
+	m_frontTextureOffsetX = record.m_textureRects[4];
+	m_frontTextureOffsetY = record.m_textureRects[5];
+	m_frontTextureWidth = record.m_textureRects[6];
+	m_frontTextureHeight = record.m_textureRects[7];
+	m_rightTextureOffsetX = record.m_textureRects[8];
+	m_rightTextureOffsetY = record.m_textureRects[9];
+	m_rightTextureWidth = record.m_textureRects[10];
+	m_rightTextureHeight = record.m_textureRects[11];
+	m_drawType = static_cast<ShapeDrawType>(record.m_drawType);
+	m_Scaling = Vector3{ record.m_scaling[0], record.m_scaling[1], record.m_scaling[2] };
+	m_TweakPos = Vector3{ record.m_tweakPos[0], record.m_tweakPos[1], record.m_tweakPos[2] };
+	m_rotation = record.m_rotation;
+	for (int i = 0; i < 6; ++i)
+	{
+		m_sideTextures[i] = static_cast<CuboidTexture>(record.m_sideTextures[i]);
+	}
 
-	Init(m_shape, m_frame, false);
+	m_customMeshName = customMeshName;
+	m_meshOutline = record.m_meshOutline != 0;
 
+	m_useShapePointer = record.m_useShapePointer != 0;
+	m_pointerShape = record.m_pointerShape;
+	m_pointerFrame = record.m_pointerFrame;
+
+	Init(m_shape, m_frame, false);
 }
 
 void ShapeData::ResetTopTexture()
@@ -535,6 +536,15 @@ void ShapeData::SetupDrawTypes()
 	m_cuboidModels[static_cast<int>(CuboidSides::CUBOID_BACK)] = LoadModelFromMesh(backMesh);
 	SetTextureForMeshFromSideData(CuboidSides::CUBOID_BACK);
 
+	if (g_indexedTextures)
+	{
+		UsePaletteShader(m_flatModel.materials[0]);
+		for (auto& model : m_cuboidModels)
+		{
+			UsePaletteShader(model.materials[0]);
+		}
+	}
+
 	//  CUSTOM MESH
 	m_customMesh = g_ResourceManager->GetModel(m_customMeshName);
 
@@ -542,6 +552,9 @@ void ShapeData::SetupDrawTypes()
 
 void ShapeData::FixupTextures()
 {
+	//  The images are about to change, so the atlas copies won't match anymore.
+	LeaveAtlas();
+
 	//  Fixup the texture for this object.
 
 	ObjectData* objectData = &g_objectTable[m_shape];
@@ -669,13 +682,29 @@ void ShapeData::Draw(const Vector3& pos, float angle, Color color, Vector3 scali
 
 	case ShapeDrawType::OBJECT_DRAW_BILLBOARD:
 	{
+		Texture texture = m_originalTexture->m_Texture;
+		Rectangle source = Rectangle{ 0, 0, float(texture.width), float(texture.height) };
+		const AtlasRect& rect = m_atlasRects[static_cast<int>(ShapeAtlasImage::ATLAS_ORIGINAL)];
+		if (m_inAtlas && rect.m_page >= 0)
+		{
+			texture = g_ShapeAtlas->GetPageTexture(rect.m_page);
+			source = rect.m_source;
+		}
+
 		finalPos = pos;
 		finalPos.x += .5f;
 		finalPos.z += .5f;
 		finalPos.y += m_Dims.y * .60f;
 
-		BeginShaderMode(g_alphaDiscard);
-		DrawBillboardPro(g_camera, m_originalTexture->m_Texture, Rectangle{ 0, 0, float(m_originalTexture->m_Texture.width), float(m_originalTexture->m_Texture.height) }, finalPos, Vector3{ 0, 1, 0 },
+		if (g_indexedTextures)
+		{
+			BeginPaletteShaderMode();
+		}
+		else
+		{
+			BeginShaderMode(g_alphaDiscard);
+		}
+		DrawBillboardPro(g_camera, texture, source, finalPos, Vector3{ 0, 1, 0 },
 			Vector2{ m_Dims.x, m_Dims.y }, Vector2{ 0, 0 }, -45, color);
 		EndShaderMode();
 		break;
@@ -728,6 +757,56 @@ void ShapeData::Draw(const Vector3& pos, float angle, Color color, Vector3 scali
 
 void ShapeData::SetTextureForMeshFromSideData(CuboidSides side)
 {
+	if (m_inAtlas)
+	{
+		ShapeAtlasImage image;
+		bool flipU = false;
+		bool flipV = false;
+		switch (m_sideTextures[static_cast<int>(side)])
+		{
+		case CuboidTexture::CUBOID_DRAW_TOP:
+		{
+			image = ShapeAtlasImage::ATLAS_TOP;
+			break;
+		}
+		case CuboidTexture::CUBOID_DRAW_FRONT:
+		{
+			image = ShapeAtlasImage::ATLAS_FRONT;
+			break;
+		}
+		case CuboidTexture::CUBOID_DRAW_RIGHT:
+		{
+			image = ShapeAtlasImage::ATLAS_RIGHT;
+			break;
+		}
+		case CuboidTexture::CUBOID_DRAW_TOP_INVERTED:
+		{
+			image = ShapeAtlasImage::ATLAS_TOP;
+			flipU = true;
+			break;
+		}
+		case CuboidTexture::CUBOID_DRAW_FRONT_INVERTED:
+		{
+			image = ShapeAtlasImage::ATLAS_FRONT;
+			flipU = true;
+			break;
+		}
+		case CuboidTexture::CUBOID_DRAW_RIGHT_INVERTED:
+		{
+			image = ShapeAtlasImage::ATLAS_RIGHT;
+			flipV = true;
+			break;
+		}
+		default:
+		{
+			return;
+		}
+		}
+
+		SetAtlasTexture(m_cuboidModels[static_cast<int>(side)], image, flipU, flipV);
+		return;
+	}
+
 	switch (m_sideTextures[static_cast<int>(side)])
 	{
 	case CuboidTexture::CUBOID_INVALID:
@@ -789,4 +868,78 @@ void ShapeData::UpdateShapePointerTexture()
 	}
 
 	m_shapePointerTexture->AssignImage(g_shapeTable[m_pointerShape][m_pointerFrame].GetDefaultTextureImage());
-}
\ No newline at end of file
+}
+
+void ShapeData::AddAtlasImages(std::vector<Image>& images) const
+{
+	images.push_back(m_originalTexture->m_Image);
+	images.push_back(m_topTexture->m_Image);
+	images.push_back(m_frontTexture->m_Image);
+	images.push_back(m_rightTexture->m_Image);
+}
+
+void ShapeData::UseAtlas(const AtlasRect* rects)
+{
+	if (!m_isValid)
+	{
+		return;
+	}
+
+	for (int i = 0; i < m_atlasRects.size(); ++i)
+	{
+		m_atlasRects[i] = rects[i];
+	}
+	m_inAtlas = true;
+
+	SetAtlasTexture(m_flatModel, ShapeAtlasImage::ATLAS_ORIGINAL, false, false);
+	UpdateAllCuboidTextures();
+}
+
+void ShapeData::LeaveAtlas()
+{
+	if (!m_inAtlas)
+	{
+		return;
+	}
+	m_inAtlas = false;
+
+	SetPlaneTexcoords(m_flatModel.meshes[0], Rectangle{ 0, 0, 1, 1 }, false, false);
+	SetMaterialTexture(&m_flatModel.materials[0], MATERIAL_MAP_DIFFUSE, m_originalTexture->m_Texture);
+	for (auto& model : m_cuboidModels)
+	{
+		SetPlaneTexcoords(model.meshes[0], Rectangle{ 0, 0, 1, 1 }, false, false);
+	}
+	UpdateAllCuboidTextures();
+}
+
+//  Points a model at its image in the atlas, or at the image's own texture if
+//  it didn't make it into the atlas.
+void ShapeData::SetAtlasTexture(Model& model, ShapeAtlasImage image, bool flipU, bool flipV)
+{
+	const AtlasRect& rect = m_atlasRects[static_cast<int>(image)];
+	if (rect.m_page >= 0)
+	{
+		SetPlaneTexcoords(model.meshes[0], rect.m_uv, flipU, flipV);
+		SetMaterialTexture(&model.materials[0], MATERIAL_MAP_DIFFUSE, g_ShapeAtlas->GetPageTexture(rect.m_page));
+		return;
+	}
+
+	Texture texture = m_originalTexture->m_Texture;
+	if (image == ShapeAtlasImage::ATLAS_TOP)
+	{
+		texture = m_topTexture->m_Texture;
+	}
+	else if (image == ShapeAtlasImage::ATLAS_FRONT)
+	{
+		texture = m_frontTexture->m_Texture;
+	}
+	else if (image == ShapeAtlasImage::ATLAS_RIGHT)
+	{
+		texture = m_rightTexture->m_Texture;
+	}
+
+	//  Only the plain images have textures of their own; the flipped ones are
+	//  flipped with UVs instead.
+	SetPlaneTexcoords(model.meshes[0], Rectangle{ 0, 0, 1, 1 }, flipU, flipV);
+	SetMaterialTexture(&model.materials[0], MATERIAL_MAP_DIFFUSE, texture);
+}
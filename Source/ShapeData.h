@@ -11,11 +11,14 @@
 #define _SHAPEDATA_H_
 
 #include <vector>
+#include "ShapeAtlas.h"
 
 struct Texture;
 
 struct coords;
 
+struct ShapeTableRecord;
+
 constexpr char* ShapeDrawTypeStrings[5] = {"Bboard", "Cuboid", "Flat", "Mesh", "Character"};
 
 enum class CuboidTexture
@@ -52,6 +55,16 @@ enum class CuboidSides
 	CUBOID_LAST
 };
 
+//  The images each frame puts in the shape atlas, in order.
+enum class ShapeAtlasImage
+{
+	ATLAS_ORIGINAL = 0,
+	ATLAS_TOP,
+	ATLAS_FRONT,
+	ATLAS_RIGHT,
+	ATLAS_LAST
+};
+
 class ShapeData
 {
 public:
@@ -63,8 +76,10 @@ public:
 	void SetupDrawTypes();
 	void FixupTextures();
 
-	void Serialize(std::ofstream& outputStream );
-	void Deserialize(std::ifstream& inputStream);
+	//  To and from a shapetable record (see ShapeTableFile.h).  The mesh name
+	//  lives in the file's string table, so the caller looks after it.
+	void Serialize(ShapeTableRecord& record) const;
+	void Deserialize(const ShapeTableRecord& record, const std::string& customMeshName);
 
 	void Draw(const Vector3& pos, float angle, Color color = Color{ 255, 255, 255, 255 }, Vector3 scaling =  Vector3{ 1, 1, 1 });
 
@@ -98,6 +113,16 @@ public:
 	void UpdateAllCuboidTextures();
 	void UpdateShapePointerTexture();
 
+	//  Adds this frame's images to a list for the shape atlas, in ShapeAtlasImage order.
+	void AddAtlasImages(std::vector<Image>& images) const;
+
+	//  Switches billboard, flat and cuboid drawing over to the atlas, given where
+	//  the images from AddAtlasImages() went.  Anything that changes the images
+	//  (FixupTextures()) switches the frame back to its own textures.
+	void UseAtlas(const AtlasRect* rects);
+	void LeaveAtlas();
+	bool IsInAtlas() { return m_inAtlas; }
+
 	bool Pick(Vector3 thisPos);
 
 	// In original pixels
@@ -170,6 +195,12 @@ public:
 	Model* m_customMesh = nullptr;
 
 	bool m_meshOutline = true;
+
+	bool m_inAtlas = false;
+	std::array<AtlasRect, static_cast<int>(ShapeAtlasImage::ATLAS_LAST)> m_atlasRects;
+
+private:
+	void SetAtlasTexture(Model& model, ShapeAtlasImage image, bool flipU, bool flipV);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "ShapeDecoder.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+void ExpandPaletteSpan(const unsigned char* indices, int count, const unsigned int* palette, unsigned int* dest)
+{
+	int i = 0;
+
+#if defined(__AVX2__)
+	//  Eight lookups per gather.
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i bytes = _mm_loadl_epi64((const __m128i*)(indices + i));
+		__m256i lanes = _mm256_cvtepu8_epi32(bytes);
+		__m256i colors = _mm256_i32gather_epi32((const int*)palette, lanes, 4);
+		_mm256_storeu_si256((__m256i*)(dest + i), colors);
+	}
+#elif defined(__SSE2__) || defined(_M_X64)
+	//  No gather before AVX2, so look up four at a time and store them together.
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i colors = _mm_set_epi32(palette[indices[i + 3]], palette[indices[i + 2]], palette[indices[i + 1]], palette[indices[i]]);
+		_mm_storeu_si128((__m128i*)(dest + i), colors);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dest[i] = palette[indices[i]];
+	}
+}
+
+void FillSpan(unsigned int* dest, int count, unsigned int value)
+{
+	int i = 0;
+
+#if defined(__AVX2__)
+	__m256i wide = _mm256_set1_epi32(value);
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_si256((__m256i*)(dest + i), wide);
+	}
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+	__m128i colors = _mm_set1_epi32(value);
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)(dest + i), colors);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		dest[i] = value;
+	}
+}
+
+bool ReadShapeFrameHeader(ByteReader& reader, ShapeFrameHeader& header)
+{
+	header.W2 = reader.ReadS16();
+	header.W1 = reader.ReadS16();
+	header.H1 = reader.ReadS16();
+	header.H2 = reader.ReadS16();
+
+	header.width = header.W2 + header.W1 + 1;
+	header.height = header.H1 + header.H2 + 1;
+
+	header.xDrawOffset = header.W2;
+	header.yDrawOffset = header.H2;
+
+	return !reader.Failed() && header.width > 0 && header.height > 0;
+}
+
+//  Clips a horizontal run of pixels at (x, y) against the frame.  Returns the
+//  number of pixels left to draw, and how many were cut off the left side.
+static inline int ClipSpan(const ShapeFrameHeader& header, int x, int y, int count, int& skip)
+{
+	skip = 0;
+	if (y < 0 || y >= header.height)
+	{
+		return 0;
+	}
+
+	if (x < 0)
+	{
+		skip = -x;
+	}
+
+	int end = x + count;
+	if (end > header.width)
+	{
+		end = header.width;
+	}
+
+	return end - (x + skip);
+}
+
+//  The span walking is the same whatever the pixels end up as; Output says what
+//  to do with a run of raw indices (Raw) and a repeated index (Fill), given the
+//  pixel offset to start at.
+template <typename Output>
+static bool DecodeSpans(ByteReader& reader, const ShapeFrameHeader& header, Output& output)
+{
+	while (true)
+	{
+		unsigned short blockData = reader.ReadU16();
+		int spanLength = blockData >> 1;
+		int spanType = blockData & 1;
+
+		if (blockData == 0)
+		{
+			break; //  There are no more spans; we're done with this frame.
+		}
+
+		int xStart = reader.ReadS16();
+		int yStart = reader.ReadS16();
+		xStart += header.width - header.xDrawOffset - 1;
+		yStart += header.height - header.yDrawOffset - 1;
+
+		if (reader.Failed())
+		{
+			return false;
+		}
+
+		int skip;
+
+		if (spanType == 0) // Not RLE, raw pixel data.
+		{
+			if (reader.Remaining() < (unsigned int)spanLength)
+			{
+				return false;
+			}
+
+			int count = ClipSpan(header, xStart, yStart, spanLength, skip);
+			if (count > 0)
+			{
+				output.Raw(yStart * header.width + xStart + skip, reader.Current() + skip, count);
+			}
+			reader.Skip(spanLength);
+		}
+		else // RLE.
+		{
+			int endX = xStart + spanLength;
+
+			while (xStart < endX)
+			{
+				unsigned char runData = reader.ReadU8();
+				int runLength = runData >> 1;
+				int runType = runData & 1;
+
+				if (reader.Failed())
+				{
+					return false;
+				}
+
+				if (runType == 0) // Once again, non-RLE
+				{
+					if (reader.Remaining() < (unsigned int)runLength)
+					{
+						return false;
+					}
+
+					int count = ClipSpan(header, xStart, yStart, runLength, skip);
+					if (count > 0)
+					{
+						output.Raw(yStart * header.width + xStart + skip, reader.Current() + skip, count);
+					}
+					reader.Skip(runLength);
+				}
+				else
+				{
+					unsigned char value = reader.ReadU8();
+					if (reader.Failed())
+					{
+						return false;
+					}
+
+					int count = ClipSpan(header, xStart, yStart, runLength, skip);
+					if (count > 0)
+					{
+						output.Fill(yStart * header.width + xStart + skip, value, count);
+					}
+				}
+
+				//  A zero-length run would never finish the span.
+				if (runLength == 0)
+				{
+					return false;
+				}
+
+				xStart += runLength;
+			}
+		}
+	}
+
+	return true;
+}
+
+struct RGBAOutput
+{
+	const unsigned int* palette;
+	unsigned int* pixels;
+
+	void Raw(int offset, const unsigned char* indices, int count) { ExpandPaletteSpan(indices, count, palette, pixels + offset); }
+	void Fill(int offset, unsigned char value, int count) { FillSpan(pixels + offset, count, palette[value]); }
+};
+
+struct IndexedOutput
+{
+	unsigned char* pixels;
+
+	void Raw(int offset, const unsigned char* indices, int count) { memcpy(pixels + offset, indices, count); }
+	void Fill(int offset, unsigned char value, int count) { memset(pixels + offset, value, count); }
+};
+
+bool DecodeShapeFrame(ByteReader& reader, const ShapeFrameHeader& header, const unsigned int* palette, unsigned int* pixels)
+{
+	RGBAOutput output{ palette, pixels };
+	return DecodeSpans(reader, header, output);
+}
+
+bool DecodeShapeFrameIndexed(ByteReader& reader, const ShapeFrameHeader& header, unsigned char* pixels)
+{
+	IndexedOutput output{ pixels };
+	return DecodeSpans(reader, header, output);
+}
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     SHAPEDECODER.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Decodes Ultima VII RLE shape frames straight into a pixel
+//           buffer.  A frame is a small header (the four extents W2, W1,
+//           H1, H2) followed by a list of spans.  Each span is either raw
+//           palette indices or a series of runs; runs are either raw
+//           indices again or a single index repeated.
+//
+//           Runs are filled as blocks and raw indices are expanded
+//           through the palette several pixels at a time, instead of
+//           going through ImageDrawPixel() one pixel at a time.  Spans
+//           that fall outside the frame are clipped, which is what
+//           ImageDrawPixel() used to do for us.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _SHAPEDECODER_H_
+#define _SHAPEDECODER_H_
+
+#include "FlxArchive.h"
+
+struct ShapeFrameHeader
+{
+	short W2;
+	short W1;
+	short H1;
+	short H2;
+
+	int width;
+	int height;
+	int xDrawOffset;
+	int yDrawOffset;
+};
+
+//  Reads the frame extents from the start of a frame.  Returns false if the
+//  data ran out or the frame has no area.
+bool ReadShapeFrameHeader(ByteReader& reader, ShapeFrameHeader& header);
+
+//  Decodes the spans following the header into pixels, which must hold
+//  width * height RGBA8 pixels and should already be cleared to transparent.
+//  The palette is 256 packed RGBA8 entries (the same memory layout as
+//  raylib's Color).  Returns false if the span data was truncated.
+bool DecodeShapeFrame(ByteReader& reader, const ShapeFrameHeader& header, const unsigned int* palette, unsigned int* pixels);
+
+//  The same, but leaves the pixels as palette indices, one byte each.  They
+//  should already be cleared to SHAPE_TRANSPARENT_INDEX.
+bool DecodeShapeFrameIndexed(ByteReader& reader, const ShapeFrameHeader& header, unsigned char* pixels);
+
+//  Shapes never use the last palette entry, so indexed frames use it for
+//  pixels that aren't drawn.
+const unsigned char SHAPE_TRANSPARENT_INDEX = 255;
+
+//  dest[i] = palette[indices[i]] for count pixels.
+void ExpandPaletteSpan(const unsigned char* indices, int count, const unsigned int* palette, unsigned int* dest);
+
+//  dest[i] = value for count pixels.
+void FillSpan(unsigned int* dest, int count, unsigned int value);
+
+#endif
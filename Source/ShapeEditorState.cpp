@@ -4,6 +4,7 @@
 #include "Geist/ResourceManager.h"
 #include "U7Globals.h"
 #include "ShapeEditorState.h"
+#include "ShapeTableFile.h"
 #include "rlgl.h"
 
 #include <list>
@@ -290,35 +291,22 @@ void ShapeEditorState::Update()
 	//  Handle GUI Input
 	if (m_currentGui->GetActiveElementID() == GE_SAVEBUTTON)
 	{
-		ofstream file("Data/shapetable.dat", ios::trunc);
-		if (file.is_open())
+		if (!ShapeTableFile::Save("Data/shapetable.bin", "Data/shapetable.dat"))
 		{
-			for (int i = 150; i < 1024; ++i)
-			{
-				for (int j = 0; j < 32; ++j)
-				{
-					ShapeData& shapeData = g_shapeTable[i][j];
-					shapeData.Serialize(file);
-				}
-			}
-			file.close();
+			AddConsoleString("Could not save the shape table.");
 		}
 	}
 
 	if (m_currentGui->GetActiveElementID() == GE_LOADBUTTON)
 	{
-		ifstream file("Data/shapetable.dat");
-		if (file.is_open())
+		ShapeTableFile file;
+		if (file.Open("Data/shapetable.bin", "Data/shapetable.dat") ||
+			(ShapeTableFile::ImportText("Data/shapetable.dat", "Data/shapetable.bin") && file.Open("Data/shapetable.bin", "Data/shapetable.dat")))
 		{
-			for (int i = 150; i < 1024; ++i)
+			for (int i = ShapeTableFile::FIRST_SHAPE; i < 1024; ++i)
 			{
-				for (int j = 0; j < 32; ++j)
-				{
-					ShapeData& shapeData = g_shapeTable[i][j];
-					shapeData.Deserialize(file);
-				}
+				file.ApplyShape(i);
 			}
-			file.close();
 		}
 	}
 
@@ -1070,14 +1058,14 @@ void ShapeEditorState::Draw()
 		float yoffset = g_fontSize + 2;
 		DrawRectangleLinesEx({ 0, yoffset, float(d->width) * scale + scale + scale, float(d->height) * scale + scale + scale }, scale, WHITE);
 		yoffset += scale;
-		DrawTextureEx(*d, Vector2{  scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
+		DrawShapeTextureEx(*d, Vector2{  scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
 
 		//  Draw top texture with labels and borders
 		yoffset += float(d->height) * scale + scale + scale;
 		float rightoffset = yoffset;
 		DrawTextEx(*g_Font.get(), "Top Texture", { 0, yoffset }, g_fontSize, 1, WHITE);
 		yoffset += g_fontSize + 2 + scale;
-		DrawTextureEx(*d, Vector2{ scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
+		DrawShapeTextureEx(*d, Vector2{ scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
 		yoffset -= scale;
 		DrawRectangleLinesEx({ 0, yoffset, float(t->width) * scale + scale + scale, float(t->height) * scale + scale + scale }, scale, WHITE);
 
@@ -1085,7 +1073,7 @@ void ShapeEditorState::Draw()
 		yoffset += float(d->height) * scale + scale + scale;
 		DrawTextEx(*g_Font.get(), "Front Texture", { 0, yoffset }, g_fontSize, 1, WHITE);
 		yoffset += g_fontSize + 2 + scale;
-		DrawTextureEx(*f, Vector2{ scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
+		DrawShapeTextureEx(*f, Vector2{ scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
 		yoffset -= scale;
 		DrawRectangleLinesEx({ 0, yoffset, float(f->width) * scale + scale + scale, float(f->height) * scale + scale + scale }, scale, WHITE);
 
@@ -1095,7 +1083,7 @@ void ShapeEditorState::Draw()
 		float xoffset = d->width * scale + scale + scale + scale;
 		DrawTextEx(*g_Font.get(), "Right Texture", { xoffset, yoffset }, g_fontSize, 1, WHITE);
 		yoffset += g_fontSize + 2 + scale;
-		DrawTextureEx(*r, Vector2{ xoffset + scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
+		DrawShapeTextureEx(*r, Vector2{ xoffset + scale, yoffset }, 0, scale, Color{ 255, 255, 255, 255 });
 		yoffset -= scale;
 		DrawRectangleLinesEx({ xoffset, yoffset, float(r->width) * scale + scale + scale, float(r->height) * scale + scale + scale }, scale, WHITE);
 	}
@@ -1103,7 +1091,7 @@ void ShapeEditorState::Draw()
 	if (g_shapeTable[m_currentShape][m_currentFrame].GetDrawType() == ShapeDrawType::OBJECT_DRAW_BILLBOARD)
 	{
 		Texture* d = g_shapeTable[m_currentShape][m_currentFrame].GetTexture();
-		DrawTextureEx(*d, Vector2{ 0, 0 }, 0, scale, Color{ 255, 255, 255, 255 });
+		DrawShapeTextureEx(*d, Vector2{ 0, 0 }, 0, scale, Color{ 255, 255, 255, 255 });
 	}
 
 	BeginMode3D(g_camera);
@@ -0,0 +1,284 @@
+#include "Geist/Globals.h"
+#include "Geist/Logging.h"
+#include "U7Globals.h"
+#include "ShapeTableFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+static_assert(sizeof(ShapeTableRecord) == 76, "ShapeTableRecord has picked up padding");
+
+//  "U7ST", then the version, the table's dimensions, the record size and the
+//  string table's length.  The records come right after, then the strings.
+static const unsigned int SHAPETABLE_MAGIC = 0x54533755;
+static const unsigned int SHAPETABLE_HEADER_SIZE = 32;
+static const unsigned int SHAPETABLE_RECORD_COUNT = ShapeTableFile::SHAPE_COUNT * ShapeTableFile::FRAME_COUNT;
+
+bool ShapeTableFile::Open(const string& filename, const string& textFilename)
+{
+	if (!m_cache.Open(filename, AssetCache::HashFiles({ textFilename })))
+	{
+		return false;
+	}
+
+	return ReadHeader();
+}
+
+bool ShapeTableFile::ReadHeader()
+{
+	ByteReader reader(m_cache.GetPayload());
+	unsigned int magic = reader.ReadU32();
+	unsigned int version = reader.ReadU32();
+	unsigned int firstShape = reader.ReadU32();
+	unsigned int shapeCount = reader.ReadU32();
+	unsigned int frameCount = reader.ReadU32();
+	unsigned int recordSize = reader.ReadU32();
+	unsigned int stringsLength = reader.ReadU32();
+	reader.Skip(4);
+
+	if (reader.Failed() || magic != SHAPETABLE_MAGIC || version != VERSION || firstShape != FIRST_SHAPE || shapeCount != SHAPE_COUNT ||
+		frameCount != FRAME_COUNT || recordSize != sizeof(ShapeTableRecord) ||
+		reader.Remaining() != SHAPETABLE_RECORD_COUNT * sizeof(ShapeTableRecord) + stringsLength ||
+		stringsLength == 0 || reader.Current()[reader.Remaining() - 1] != 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_records = (const ShapeTableRecord*)reader.Current();
+	m_strings = (const char*)(reader.Current() + SHAPETABLE_RECORD_COUNT * sizeof(ShapeTableRecord));
+
+	//  Every name has to land inside the table, or GetString() could run off the end.
+	for (unsigned int i = 0; i < SHAPETABLE_RECORD_COUNT; ++i)
+	{
+		if (m_records[i].m_customMeshName >= stringsLength)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const ShapeTableRecord& ShapeTableFile::GetRecord(int shape, int frame) const
+{
+	return m_records[(shape - FIRST_SHAPE) * FRAME_COUNT + frame];
+}
+
+void ShapeTableFile::ApplyShape(int shape) const
+{
+	for (int frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		const ShapeTableRecord& record = GetRecord(shape, frame);
+		g_shapeTable[shape][frame].Deserialize(record, GetString(record.m_customMeshName));
+	}
+}
+
+unsigned int ShapeTableFile::AddString(string& strings, const string& value)
+{
+	//  The same few meshes are used over and over, so share them.  A match on
+	//  the tail of a longer name is fine too; it's still null terminated.
+	string terminated = value + '\0';
+	size_t offset = strings.find(terminated);
+	if (offset == string::npos)
+	{
+		offset = strings.size();
+		strings.append(terminated);
+	}
+
+	return (unsigned int)offset;
+}
+
+bool ShapeTableFile::Save(const string& filename, const string& textFilename)
+{
+	vector<ShapeTableRecord> records(SHAPETABLE_RECORD_COUNT);
+	string strings;
+
+	for (int i = FIRST_SHAPE; i < 1024; ++i)
+	{
+		for (int j = 0; j < FRAME_COUNT; ++j)
+		{
+			ShapeData& shapeData = g_shapeTable[i][j];
+			ShapeTableRecord& record = records[(i - FIRST_SHAPE) * FRAME_COUNT + j];
+			shapeData.Serialize(record);
+			record.m_customMeshName = AddString(strings, shapeData.m_customMeshName);
+		}
+	}
+
+	//  The binary is keyed on the text, so the text has to be written first.
+	if (!WriteText(textFilename, records, strings))
+	{
+		return false;
+	}
+
+	return WriteBinary(filename, AssetCache::HashFiles({ textFilename }), records, strings);
+}
+
+bool ShapeTableFile::ReadText(const string& textFilename, vector<ShapeTableRecord>& records, string& strings)
+{
+	ifstream file(textFilename, ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	istringstream inStream(text);
+
+	records.assign(SHAPETABLE_RECORD_COUNT, ShapeTableRecord());
+	strings.clear();
+
+	for (auto& record : records)
+	{
+		int shape, frame, drawType, outline, useShapePointer, pointerShape, pointerFrame;
+		int textureRects[12];
+		int sideTextures[6];
+		string meshName;
+
+		inStream >> shape >> frame;
+		for (int& value : textureRects)
+		{
+			inStream >> value;
+		}
+		inStream >> drawType;
+		for (float& value : record.m_scaling)
+		{
+			inStream >> value;
+		}
+		for (float& value : record.m_tweakPos)
+		{
+			inStream >> value;
+		}
+		inStream >> record.m_rotation;
+		for (int& value : sideTextures)
+		{
+			inStream >> value;
+		}
+		inStream >> meshName >> outline >> useShapePointer >> pointerShape >> pointerFrame;
+
+		if (inStream.fail())
+		{
+			Log("Shape table " + textFilename + " is too short or damaged.");
+			return false;
+		}
+
+		record.m_shape = shape;
+		record.m_frame = frame;
+		for (int i = 0; i < 12; ++i)
+		{
+			record.m_textureRects[i] = textureRects[i];
+		}
+		record.m_drawType = drawType;
+		for (int i = 0; i < 6; ++i)
+		{
+			record.m_sideTextures[i] = sideTextures[i];
+		}
+		record.m_customMeshName = AddString(strings, meshName);
+		record.m_meshOutline = outline;
+		record.m_useShapePointer = useShapePointer;
+		record.m_pointerShape = pointerShape;
+		record.m_pointerFrame = pointerFrame;
+	}
+
+	return true;
+}
+
+bool ShapeTableFile::WriteText(const string& textFilename, const vector<ShapeTableRecord>& records, const string& strings)
+{
+	//  Same layout ShapeData::Serialize() always wrote, one line per frame.
+	ostringstream outStream;
+	for (auto& record : records)
+	{
+		outStream << record.m_shape << " ";
+		outStream << record.m_frame << " ";
+		for (int i = 0; i < 12; ++i)
+		{
+			outStream << record.m_textureRects[i] << " ";
+		}
+		outStream << int(record.m_drawType) << " ";
+		for (int i = 0; i < 3; ++i)
+		{
+			outStream << record.m_scaling[i] << " ";
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			outStream << record.m_tweakPos[i] << " ";
+		}
+		outStream << record.m_rotation << " ";
+		for (int i = 0; i < 6; ++i)
+		{
+			outStream << int(record.m_sideTextures[i]) << " ";
+		}
+		outStream << &strings[record.m_customMeshName] << " ";
+		outStream << int(record.m_meshOutline) << " ";
+		outStream << int(record.m_useShapePointer) << " ";
+		outStream << record.m_pointerShape << " ";
+		outStream << record.m_pointerFrame << " ";
+		outStream << "\n";
+	}
+
+	ofstream file(textFilename, ios::binary | ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	string text = outStream.str();
+	file.write(text.data(), text.size());
+	return file.good();
+}
+
+bool ShapeTableFile::WriteBinary(const string& filename, unsigned long long key, const vector<ShapeTableRecord>& records, const string& strings)
+{
+	if (records.size() != SHAPETABLE_RECORD_COUNT)
+	{
+		return false;
+	}
+
+	unsigned int header[SHAPETABLE_HEADER_SIZE / 4] = { SHAPETABLE_MAGIC, VERSION, FIRST_SHAPE, SHAPE_COUNT, FRAME_COUNT,
+		sizeof(ShapeTableRecord), (unsigned int)strings.size() + 1, 0 };
+
+	//  Put the whole thing together first so it goes out in one write.
+	vector<unsigned char> payload(sizeof(header) + records.size() * sizeof(ShapeTableRecord) + strings.size() + 1, 0);
+	memcpy(payload.data(), header, sizeof(header));
+	memcpy(payload.data() + sizeof(header), records.data(), records.size() * sizeof(ShapeTableRecord));
+	memcpy(payload.data() + sizeof(header) + records.size() * sizeof(ShapeTableRecord), strings.data(), strings.size());
+
+	AssetCacheWriter writer;
+	if (!writer.Begin(filename, key))
+	{
+		return false;
+	}
+	writer.Write(payload.data(), (unsigned int)payload.size());
+	return writer.Finish();
+}
+
+bool ShapeTableFile::ImportText(const string& textFilename, const string& filename)
+{
+	vector<ShapeTableRecord> records;
+	string strings;
+	if (!ReadText(textFilename, records, strings))
+	{
+		return false;
+	}
+
+	return WriteBinary(filename, AssetCache::HashFiles({ textFilename }), records, strings);
+}
+
+bool ShapeTableFile::ExportText(const string& filename, const string& textFilename)
+{
+	ShapeTableFile file;
+	if (!file.m_cache.Open(filename) || !file.ReadHeader())
+	{
+		return false;
+	}
+
+	const char* stringsStart = file.m_strings;
+	const char* stringsEnd = (const char*)(file.m_cache.GetPayload().m_data + file.m_cache.GetPayload().m_length);
+	vector<ShapeTableRecord> records(file.m_records, file.m_records + SHAPETABLE_RECORD_COUNT);
+	return WriteText(textFilename, records, string(stringsStart, stringsEnd));
+}
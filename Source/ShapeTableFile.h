@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     SHAPETABLEFILE.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  The binary form of Data/shapetable.dat.  It's a fixed-size
+//           record for every shape and frame from 150 up, followed by a
+//           string table holding the custom mesh names, all inside an
+//           AssetCache file keyed by the text file it came from.
+//
+//           shapetable.dat stays the copy that gets edited and checked
+//           in; the loader imports it into shapetable.bin whenever the
+//           two don't match and then just maps the .bin.  Both files are
+//           read and written with a single I/O call.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _SHAPETABLEFILE_H_
+#define _SHAPETABLEFILE_H_
+
+#include "AssetCache.h"
+#include <string>
+#include <vector>
+
+//  Laid out so there's no padding; the file is just an array of these.
+struct ShapeTableRecord
+{
+	short m_shape;
+	short m_frame;
+
+	//  Top, front and right: x offset, y offset, width, height.
+	short m_textureRects[12];
+
+	float m_scaling[3];
+	float m_tweakPos[3];
+	float m_rotation;
+
+	unsigned int m_customMeshName;   //  Offset into the string table.
+
+	short m_pointerShape;
+	short m_pointerFrame;
+
+	unsigned char m_drawType;
+	unsigned char m_meshOutline;
+	unsigned char m_useShapePointer;
+	unsigned char m_unused1;
+
+	unsigned char m_sideTextures[6];
+	unsigned char m_unused2[2];
+};
+
+class ShapeTableFile
+{
+public:
+	//  Bump this whenever ShapeTableRecord or the layout around it changes.
+	static const unsigned int VERSION = 1;
+
+	static const int FIRST_SHAPE = 150;
+	static const int SHAPE_COUNT = 1024 - FIRST_SHAPE;
+	static const int FRAME_COUNT = 32;
+
+	ShapeTableFile() {};
+
+	//  Maps shapetable.bin.  Fails if it's missing, from another version, or
+	//  wasn't made from the current contents of textFilename.
+	bool Open(const std::string& filename, const std::string& textFilename);
+	void Close() { m_cache.Close(); }
+	bool IsOpen() const { return m_cache.IsOpen(); }
+
+	const ShapeTableRecord& GetRecord(int shape, int frame) const;
+	const char* GetString(unsigned int offset) const { return m_strings + offset; }
+
+	//  Sets up all the frames of one shape in g_shapeTable.  This creates
+	//  textures, so it has to happen on the main thread.
+	void ApplyShape(int shape) const;
+
+	//  Writes g_shapeTable out as both shapetable.dat and shapetable.bin.
+	static bool Save(const std::string& filename, const std::string& textFilename);
+
+	//  The text format, as records and a string table.
+	static bool ReadText(const std::string& textFilename, std::vector<ShapeTableRecord>& records, std::string& strings);
+	static bool WriteText(const std::string& textFilename, const std::vector<ShapeTableRecord>& records, const std::string& strings);
+	static bool WriteBinary(const std::string& filename, unsigned long long key, const std::vector<ShapeTableRecord>& records, const std::string& strings);
+
+	//  Converters between the two, for the -importshapetable and -exportshapetable
+	//  command line options.  Neither needs a window or the Ultima VII files.
+	static bool ImportText(const std::string& textFilename, const std::string& filename);
+	static bool ExportText(const std::string& filename, const std::string& textFilename);
+
+	//  Adds a string to a string table, returning its offset.
+	static unsigned int AddString(std::string& strings, const std::string& value);
+
+private:
+	bool ReadHeader();
+
+	AssetCache m_cache;
+	const ShapeTableRecord* m_records = nullptr;
+	const char* m_strings = nullptr;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "Geist/Globals.h"
+#include "Geist/Logging.h"
+#include "Geist/ThreadPool.h"
+#include "U7Globals.h"
+#include "SuperchunkStreamer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+SuperchunkStreamer::~SuperchunkStreamer()
+{
+	Shutdown();
+}
+
+void SuperchunkStreamer::Init(const string& dataPath, float radius)
+{
+	m_dataPath = dataPath;
+	m_radius = radius;
+	m_enabled = true;
+	Log("Streaming superchunks within " + to_string(int(radius)) + " tiles of the camera.");
+}
+
+void SuperchunkStreamer::Shutdown()
+{
+	//  Reads in flight write into m_superchunks.
+	for (auto& superchunk : m_superchunks)
+	{
+		if (superchunk.m_reading.valid())
+		{
+			superchunk.m_reading.wait();
+		}
+	}
+
+	m_enabled = false;
+}
+
+float SuperchunkStreamer::DistanceTo(int index, const Vector3& center) const
+{
+	float left = float((index % 12) * SUPERCHUNK_SIZE);
+	float top = float((index / 12) * SUPERCHUNK_SIZE);
+
+	float dx = max(max(left - center.x, 0.0f), center.x - (left + SUPERCHUNK_SIZE));
+	float dz = max(max(top - center.z, 0.0f), center.z - (top + SUPERCHUNK_SIZE));
+	return sqrt(dx * dx + dz * dz);
+}
+
+void SuperchunkStreamer::Update(const Vector3& center)
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	//  Read a superchunk ahead of time once it's within a superchunk of the
+	//  radius, and only throw its objects away once it's that far outside it,
+	//  so moving back and forth over an edge doesn't keep reloading it.
+	float prefetchRadius = m_radius + SUPERCHUNK_SIZE;
+
+	bool instantiated = false;
+	for (int i = 0; i < 144; ++i)
+	{
+		Superchunk& superchunk = m_superchunks[i];
+		float distance = DistanceTo(i, center);
+
+		if (superchunk.m_status == Superchunk::UNREAD && distance <= prefetchRadius)
+		{
+			Read(i);
+		}
+
+		if (superchunk.m_status == Superchunk::READING && superchunk.m_reading.wait_for(chrono::seconds(0)) == future_status::ready)
+		{
+			superchunk.m_reading.get();
+			superchunk.m_status = Superchunk::READ;
+		}
+
+		if (superchunk.m_status == Superchunk::READ && distance <= m_radius && !instantiated)
+		{
+			Instantiate(i);
+			instantiated = true;
+		}
+		else if (superchunk.m_status == Superchunk::LOADED && distance > prefetchRadius)
+		{
+			Evict(i);
+		}
+	}
+}
+
+void SuperchunkStreamer::Read(int index)
+{
+	Superchunk& superchunk = m_superchunks[index];
+	superchunk.m_status = Superchunk::READING;
+
+	string dataPath = m_dataPath;
+	superchunk.m_reading = g_ThreadPool->Submit([&superchunk, dataPath, index]()
+		{
+			int superchunkx = index % 12;
+			int superchunky = index / 12;
+
+			string filename = LoadingState::SuperchunkFilename(dataPath + "/STATIC/", "U7IFIX", index);
+			if (!LoadingState::ParseIFIXSuperchunk(filename, superchunkx, superchunky, superchunk.m_ifixObjects))
+			{
+				Log("Could not open " + filename);
+			}
+
+			filename = LoadingState::SuperchunkFilename(dataPath + "/GAMEDAT/", "U7IREG", index);
+			MappedFile u7thisireg;
+			if (u7thisireg.Open(filename))
+			{
+				LoadingState::ParseIREG(u7thisireg.GetData(), superchunkx, superchunky, superchunk.m_iregRecords);
+			}
+			else
+			{
+				Log("Could not open " + filename);
+			}
+		});
+}
+
+void SuperchunkStreamer::Instantiate(int index)
+{
+	Superchunk& superchunk = m_superchunks[index];
+
+	//  Same order as a full load: the chunk templates, then IFIX, then IREG.
+	superchunk.m_objects.clear();
+	superchunk.m_arena = g_ObjectList.GetPool().CreateArena();
+	g_ObjectList.SetArena(superchunk.m_arena);
+
+	if (!g_chunkTemplates.IsBuilt())
+	{
+		for (int chunky = 0; chunky < 16; ++chunky)
+		{
+			for (int chunkx = 0; chunkx < 16; ++chunkx)
+			{
+				LoadingState::AddChunkObjects((index % 12) * 16 + chunkx, (index / 12) * 16 + chunky, &superchunk.m_objects);
+			}
+		}
+	}
+
+	for (auto& object : superchunk.m_ifixObjects)
+	{
+		ObjectHandle id = GetNextID();
+		AddObject(object.shape, object.frame, id, object.x, object.y, object.z);
+		superchunk.m_objects.push_back(id);
+	}
+
+	LoadingState::CommitIREGRecords(superchunk.m_iregRecords, &superchunk.m_objects);
+	g_ObjectList.SetArena(ObjectPool::WORLD_ARENA);
+
+	superchunk.m_status = Superchunk::LOADED;
+	++m_loadedCount;
+}
+
+void SuperchunkStreamer::Evict(int index)
+{
+	Superchunk& superchunk = m_superchunks[index];
+
+	//  Anything that was carried out of the superchunk goes with it; nothing
+	//  moves objects around yet.  Chunk template objects that were made real
+	//  aren't on the list, so they stay.
+	for (ObjectHandle id : superchunk.m_objects)
+	{
+		g_ObjectList.Remove(id);
+	}
+	superchunk.m_objects.clear();
+
+	g_ObjectList.GetPool().ReleaseArena(superchunk.m_arena);
+	superchunk.m_arena = -1;
+
+	superchunk.m_status = Superchunk::READ;
+	--m_loadedCount;
+}
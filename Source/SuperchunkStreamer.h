@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     SUPERCHUNKSTREAMER.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  Keeps only the superchunks near the camera alive.  Superchunks
+//           coming into range have their IFIX and IREG files read on the
+//           thread pool; once they're inside the radius their objects are
+//           created, and once they're well outside it the objects are
+//           deleted again.  Each superchunk's objects get their own arena
+//           in the object pool, which is handed back whole when they go.
+//           The parsed records are kept, so coming back to a superchunk
+//           doesn't touch the disk.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _SUPERCHUNKSTREAMER_H_
+#define _SUPERCHUNKSTREAMER_H_
+
+#include "U7Globals.h"
+#include "LoadingState.h"
+#include <array>
+#include <future>
+#include <string>
+#include <vector>
+
+class SuperchunkStreamer
+{
+public:
+	SuperchunkStreamer() {};
+	~SuperchunkStreamer();
+
+	//  radius is in tiles, measured from the camera target to the nearest edge
+	//  of a superchunk.
+	void Init(const std::string& dataPath, float radius);
+	void Shutdown();
+
+	//  Call once a frame on the main thread.  Creates at most one superchunk's
+	//  objects per call so streaming doesn't hitch.
+	void Update(const Vector3& center);
+
+	bool IsEnabled() const { return m_enabled; }
+	int GetLoadedCount() const { return m_loadedCount; }
+
+	static const int SUPERCHUNK_SIZE = 256;
+
+private:
+	struct Superchunk
+	{
+		enum Status
+		{
+			UNREAD = 0,
+			READING,
+			READ,
+			LOADED
+		};
+
+		Status m_status = UNREAD;
+		std::future<void> m_reading;
+
+		std::vector<IFIXObject> m_ifixObjects;
+		std::vector<IREGRecord> m_iregRecords;
+
+		//  Everything created for it, so it can all be deleted again.
+		std::vector<ObjectHandle> m_objects;
+		int m_arena = -1;
+	};
+
+	void Read(int index);
+	void Instantiate(int index);
+	void Evict(int index);
+	float DistanceTo(int index, const Vector3& center) const;
+
+	std::array<Superchunk, 144> m_superchunks;
+	std::string m_dataPath;
+	float m_radius = 0;
+	bool m_enabled = false;
+	int m_loadedCount = 0;
+};
+
+#endif
@@ -7,9 +7,17 @@
 //  Which means that there are 36,864 chunks in the map.  But there are only 3072 unique chunks,
 //  which means some are repeated as necessary.
 //
-//  So the first thing we need to do is create a mesh for each of the 3072 chunks.
+//  So the first thing we need to do is create an image for each of the 3072 chunks.  They all
+//  share one mesh, and each frame every visible chunk is drawn in one instanced call.
 
 #include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "include/glad.h"
 
 #include "Geist/Globals.h"
 #include "Geist/RNG.h"
@@ -33,55 +41,243 @@ Terrain::~Terrain()
 
 void Terrain::Init()
 {
-   // Create the chunk database
+   Init((const unsigned char*)nullptr);
+}
 
-   //  Create a mesh for each chunk
-   Mesh mesh = GenMeshPlane(16, 16, 1, 1);
+void Terrain::Init(const unsigned char* chunkPixels)
+{
+   //  Init() can be called again, so let go of whatever the last one made.
+   Shutdown();
 
-   //  Move the mesh from the center to the corner
-   for (int i = 0; i < mesh.vertexCount; ++i)
-   {
-   	mesh.vertices[i * 3] += 8.0f;
-		mesh.vertices[i * 3 + 2] += 8.0f;
-	}
+   m_terrainShader = LoadShader("Data/Shaders/terrain.vs", "Data/Shaders/terrain.fs");
+   m_mvpLoc = GetShaderLocation(m_terrainShader, "mvp");
+   m_instanceLoc = GetShaderLocationAttrib(m_terrainShader, "instanceChunk");
+
+   CreateQuad(16);
+
+   //  Filled in and pointed at every frame in Draw().
+   glBindVertexArray(m_chunkVao);
+   glGenBuffers(1, &m_instanceBuffer);
+   glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+   glEnableVertexAttribArray(m_instanceLoc);
+   glVertexAttribDivisor(m_instanceLoc, 1);
+
+   glBindVertexArray(0);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-   UpdateMeshBuffer(mesh, 0, mesh.vertices, sizeof(float) * mesh.vertexCount * 3, 0);
+   //  Now the chunk images.
+   const int chunkImageSize = 128 * 128 * 4;
+
+   GLint maxLayers = 256;
+   glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+   m_layersPerArray = std::min(3072, int(maxLayers));
+
+   int arrayCount = (3072 + m_layersPerArray - 1) / m_layersPerArray;
+   m_chunkArrays.resize(arrayCount);
+   m_instances.resize(arrayCount);
+   glGenTextures(arrayCount, m_chunkArrays.data());
 
    unsigned short prevShape = 0;
    unsigned short prevFrame = 0;
-   for (unsigned int i = 0; i < 3072; ++i)
+   std::vector<unsigned char> img;
+   for (int i = 0; i < arrayCount; ++i)
+   {
+      int firstLayer = i * m_layersPerArray;
+      int layers = std::min(m_layersPerArray, 3072 - firstLayer);
+
+      glBindTexture(GL_TEXTURE_2D_ARRAY, m_chunkArrays[i]);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+
+      if (chunkPixels != nullptr)
+      {
+         //  The cache already has them back to back, so the whole array goes up at once.
+         glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 128, 128, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, chunkPixels + size_t(firstLayer) * chunkImageSize);
+         continue;
+      }
+
+      glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 128, 128, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+      img.resize(chunkImageSize);
+      for (int layer = 0; layer < layers; ++layer)
+      {
+         ComposeChunkImage(firstLayer + layer, img.data(), prevShape, prevFrame);
+         glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, 128, 128, 1, GL_RGBA, GL_UNSIGNED_BYTE, img.data());
+      }
+   }
+   glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void Terrain::CreateQuad(float size)
+{
+   //  Position, then UV.
+   const float quad[] = {
+      0, 0, 0,          0, 0,
+      size, 0, 0,       1, 0,
+      0, 0, size,       0, 1,
+      size, 0, 0,       1, 0,
+      size, 0, size,    1, 1,
+      0, 0, size,       0, 1,
+   };
+
+   glGenVertexArrays(1, &m_chunkVao);
+   glBindVertexArray(m_chunkVao);
+
+   glGenBuffers(1, &m_chunkVertexBuffer);
+   glBindBuffer(GL_ARRAY_BUFFER, m_chunkVertexBuffer);
+   glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+
+   int positionLoc = GetShaderLocationAttrib(m_terrainShader, "vertexPosition");
+   int texCoordLoc = GetShaderLocationAttrib(m_terrainShader, "vertexTexCoord");
+   glEnableVertexAttribArray(positionLoc);
+   glVertexAttribPointer(positionLoc, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+   if (texCoordLoc >= 0)
+   {
+      glEnableVertexAttribArray(texCoordLoc);
+      glVertexAttribPointer(texCoordLoc, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+   }
+
+   glBindVertexArray(0);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//  Makes a nearest-filtered 2D texture with no mipmaps.
+static unsigned int CreateDataTexture(GLint internalFormat, int width, int height, GLenum format, GLenum type, const void* data)
+{
+   unsigned int texture = 0;
+   glGenTextures(1, &texture);
+   glBindTexture(GL_TEXTURE_2D, texture);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+   glBindTexture(GL_TEXTURE_2D, 0);
+   return texture;
+}
+
+void Terrain::InitTiles()
+{
+   Shutdown();
+
+   m_terrainShader = LoadShader("Data/Shaders/tileTerrain.vs", "Data/Shaders/tileTerrain.fs");
+   m_mvpLoc = GetShaderLocation(m_terrainShader, "mvp");
+   CreateQuad(192 * 16);
+
+   //  The chunk map, x across and z down.
+   std::vector<unsigned short> chunkMap(192 * 192);
+   for (int x = 0; x < 192; ++x)
    {
-		m_chunkModels[i] = make_unique<Model>(LoadModelFromMesh(mesh));
+      for (int z = 0; z < 192; ++z)
+      {
+         chunkMap[z * 192 + x] = g_worldTiles.GetChunkType(x, z);
+      }
+   }
+   m_chunkMapTexture = CreateDataTexture(GL_R16UI, 192, 192, GL_RED_INTEGER, GL_UNSIGNED_SHORT, chunkMap.data());
 
-      Image img = GenImageColor(128, 128, BLACK);
+   //  Every chunk type's tiles.  Bad tiles are fixed up the same way
+   //  ComposeChunkImage() does it, so the shader never sees one.
+   std::vector<unsigned short> tileTable(3072 * 256);
+   unsigned short prevShape = 0;
+   unsigned short prevFrame = 0;
+   for (unsigned int chunkType = 0; chunkType < 3072; ++chunkType)
+   {
+      const uint16_t* tiles = g_worldTiles.GetChunkTiles(chunkType);
       for (int j = 0; j < 16; ++j)
       {
          for (int k = 0; k < 16; ++k)
          {
-            unsigned short thisdata = g_ChunkTypeList[i][j][k];
+            unsigned short thisdata = tiles[j * 16 + k];
             unsigned short shapenum = thisdata & 0x3ff;
             unsigned short framenum = (thisdata >> 10) & 0x1f;
 
             if (shapenum <= 150 && framenum < 32)
             {
-               ImageDraw(&img, m_terrainTexture, Rectangle{ shapenum * 8.0f, framenum * 8.0f, 8, 8 }, Rectangle{ k * 8.0f, j * 8.0f, 8, 8 }, WHITE);
                prevShape = shapenum;
                prevFrame = framenum;
             }
-            else
-            {
-					ImageDraw(&img, m_terrainTexture, Rectangle{ prevShape * 8.0f, prevFrame * 8.0f, 8, 8 }, Rectangle{ k * 8.0f, j * 8.0f, 8, 8 }, WHITE);
-				}
-			}
+
+            tileTable[chunkType * 256 + j * 16 + k] = prevShape | (prevFrame << 10);
+         }
       }
+   }
+   m_tileTableTexture = CreateDataTexture(GL_R16UI, 256, 3072, GL_RED_INTEGER, GL_UNSIGNED_SHORT, tileTable.data());
+
+   m_frameOffsets.fill(0);
+   m_frameOffsetTexture = CreateDataTexture(GL_R8UI, 256, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, m_frameOffsets.data());
+   m_frameOffsetsChanged = false;
+
+   m_terrainTilesTexture = CreateDataTexture(GL_RGBA8, m_terrainTexture.width, m_terrainTexture.height, GL_RGBA, GL_UNSIGNED_BYTE, m_terrainTexture.data);
+
+   rlEnableShader(m_terrainShader.id);
+   int unit = 0;
+   for (const char* name : { "chunkMap", "tileTable", "frameOffsets", "terrainTiles" })
+   {
+      SetShaderValue(m_terrainShader, GetShaderLocation(m_terrainShader, name), &unit, SHADER_UNIFORM_INT);
+      ++unit;
+   }
+   rlDisableShader();
 
-      Texture thisTexture = LoadTextureFromImage(img);
-      SetTextureFilter(thisTexture, TEXTURE_FILTER_POINT);
+   m_tileTerrain = true;
+}
 
-      SetMaterialTexture(&m_chunkModels[i]->materials[0], MATERIAL_MAP_DIFFUSE, thisTexture);
+void Terrain::SetTileFrameOffset(int shape, int offset)
+{
+   if (shape < 0 || shape >= m_frameOffsets.size())
+   {
+      return;
+   }
 
-      UnloadImage(img);
-	}
+   m_frameOffsets[shape] = (unsigned char)(offset & 31);
+   m_frameOffsetsChanged = true;
+}
+
+void Terrain::ComposeChunkImage(unsigned int chunkType, unsigned char* dest, unsigned short& prevShape, unsigned short& prevFrame)
+{
+   Color* destPixels = (Color*)dest;
+   const Color* terrainPixels = (const Color*)m_terrainTexture.data;
+
+   const uint16_t* tiles = g_worldTiles.GetChunkTiles(chunkType);
+
+   for (int j = 0; j < 16; ++j)
+   {
+      for (int k = 0; k < 16; ++k)
+      {
+         unsigned short thisdata = tiles[j * 16 + k];
+         unsigned short shapenum = thisdata & 0x3ff;
+         unsigned short framenum = (thisdata >> 10) & 0x1f;
+
+         if (shapenum <= 150 && framenum < 32)
+         {
+            prevShape = shapenum;
+            prevFrame = framenum;
+         }
+
+         //  Same result as ImageDraw() onto a black image: opaque pixels are copied,
+         //  clear ones leave the black, and the rest are blended over it.
+         for (int y = 0; y < 8; ++y)
+         {
+            const Color* src = terrainPixels + (prevFrame * 8 + y) * m_terrainTexture.width + prevShape * 8;
+            Color* dst = destPixels + (j * 8 + y) * 128 + k * 8;
+            for (int x = 0; x < 8; ++x)
+            {
+               if (src[x].a == 255)
+               {
+                  dst[x] = src[x];
+               }
+               else
+               {
+                  dst[x] = ColorAlphaBlend(BLACK, src[x], WHITE);
+               }
+            }
+         }
+      }
+   }
 }
 
 void Terrain::UpdateTerrainTexture(Image img)
@@ -91,44 +287,199 @@ void Terrain::UpdateTerrainTexture(Image img)
 
 void Terrain::Draw()
 {
-   int range = g_camera.fovy / 16 + 1;
+   if (m_chunkVao == 0)
+   {
+      return;
+   }
+
+   if (m_tileTerrain)
+   {
+      DrawTiles();
+      return;
+   }
+
+   FindVisibleChunks();
+
+   for (auto& instances : m_instances)
+   {
+      instances.clear();
+   }
+
+   size_t instanceFloats = 0;
+   for (auto& chunk : m_visibleChunks)
+   {
+      int i = int(chunk.first);
+      int j = int(chunk.second);
+
+      int chunkType = g_worldTiles.GetChunkType(i, j);
+      std::vector<float>& instances = m_instances[chunkType / m_layersPerArray];
+      instances.push_back(i * 16.0f);
+      instances.push_back(j * 16.0f);
+      instances.push_back(float(chunkType % m_layersPerArray));
+      instanceFloats += 3;
+   }
+
+   //  Anything raylib has batched up so far has to be drawn before we take over.
+   rlDrawRenderBatchActive();
 
-   int chunkx = g_camera.target.x / 16;
-   int chunky = g_camera.target.z / 16;
+   Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+   rlEnableShader(m_terrainShader.id);
+   SetShaderValueMatrix(m_terrainShader, m_mvpLoc, mvp);
 
-   for(int i = chunkx - range; i <= chunkx + range + 1; ++i)
-	{
-		for(int j = chunky - range; j <= chunky + range + 1; ++j)
-		{
-         if(i < 0 || i >= 192 || j < 0 || j >= 192)
-			{
-				continue;
-			}
+   glActiveTexture(GL_TEXTURE0);
+   glBindVertexArray(m_chunkVao);
+   glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+   glBufferData(GL_ARRAY_BUFFER, instanceFloats * sizeof(float), nullptr, GL_STREAM_DRAW);
 
-         DrawModel(*m_chunkModels[g_chunkTypeMap[i][j]], { i * 16.0f, 0, j * 16.0f }, 1.0f, WHITE);
-		}
-	}
+   size_t offset = 0;
+   for (int i = 0; i < m_instances.size(); ++i)
+   {
+      if (m_instances[i].empty())
+      {
+         continue;
+      }
+
+      glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(float), m_instances[i].size() * sizeof(float), m_instances[i].data());
+      glVertexAttribPointer(m_instanceLoc, 3, GL_FLOAT, GL_FALSE, 0, (void*)(offset * sizeof(float)));
+      glBindTexture(GL_TEXTURE_2D_ARRAY, m_chunkArrays[i]);
+      glDrawArraysInstanced(GL_TRIANGLES, 0, 6, GLsizei(m_instances[i].size() / 3));
+      offset += m_instances[i].size();
+   }
+
+   glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   glBindVertexArray(0);
+   rlDisableShader();
+}
+
+void Terrain::DrawTiles()
+{
+   rlDrawRenderBatchActive();
+
+   if (m_frameOffsetsChanged)
+   {
+      glBindTexture(GL_TEXTURE_2D, m_frameOffsetTexture);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, m_frameOffsets.data());
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      m_frameOffsetsChanged = false;
+   }
+
+   Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+   rlEnableShader(m_terrainShader.id);
+   SetShaderValueMatrix(m_terrainShader, m_mvpLoc, mvp);
+
+   unsigned int textures[] = { m_chunkMapTexture, m_tileTableTexture, m_frameOffsetTexture, m_terrainTilesTexture };
+   for (int i = 0; i < 4; ++i)
+   {
+      glActiveTexture(GL_TEXTURE0 + i);
+      glBindTexture(GL_TEXTURE_2D, textures[i]);
+   }
+
+   glBindVertexArray(m_chunkVao);
+   glDrawArrays(GL_TRIANGLES, 0, 6);
+   glBindVertexArray(0);
+
+   for (int i = 3; i >= 0; --i)
+   {
+      glActiveTexture(GL_TEXTURE0 + i);
+      glBindTexture(GL_TEXTURE_2D, 0);
+   }
+   rlDisableShader();
 }
 
 void Terrain::Shutdown()
 {
-   
+   //  Nothing to let go of if Init() never ran, which is also the only time
+   //  there's no GL to call.
+   if (m_chunkVao == 0)
+   {
+      return;
+   }
+
+   glDeleteTextures(GLsizei(m_chunkArrays.size()), m_chunkArrays.data());
+   m_chunkArrays.clear();
+   m_instances.clear();
+
+   unsigned int tileTextures[] = { m_chunkMapTexture, m_tileTableTexture, m_frameOffsetTexture, m_terrainTilesTexture };
+   glDeleteTextures(4, tileTextures);
+   m_chunkMapTexture = 0;
+   m_tileTableTexture = 0;
+   m_frameOffsetTexture = 0;
+   m_terrainTilesTexture = 0;
+   m_tileTerrain = false;
+
+   glDeleteBuffers(1, &m_instanceBuffer);
+   glDeleteBuffers(1, &m_chunkVertexBuffer);
+   glDeleteVertexArrays(1, &m_chunkVao);
+   m_instanceBuffer = 0;
+   m_chunkVertexBuffer = 0;
+   m_chunkVao = 0;
+
+   UnloadShader(m_terrainShader);
+   m_terrainShader = Shader{ 0 };
 }
 
 bool Terrain::IsChunkVisible(int x, int y)
 {
-   return false;
+   if (x < 0 || y < 0 || x >= WorldTiles::MAP_CHUNKS || y >= WorldTiles::MAP_CHUNKS || m_chunkIsVisible.empty())
+   {
+      return false;
+   }
+
+   return m_chunkIsVisible[y * WorldTiles::MAP_CHUNKS + x];
 }
 
 void Terrain::Update()
 {
-   if (g_CameraMoved)
-   {
-      FindVisibleChunks();
-   }
+   FindVisibleChunks();
 }
 
 void Terrain::FindVisibleChunks()
 {
-    m_visibleChunks.clear();
+   FindVisibleChunks(GetCameraFrustum(g_camera));
+}
+
+void Terrain::FindVisibleChunks(const CameraFrustum& frustum)
+{
+   //  The camera isn't always moved by DoCameraMovement() (the title screen
+   //  turns it itself), so this checks for itself whether it's moved.
+   if (m_visibleChunksFound && frustum == m_visibleChunksFrustum)
+   {
+      return;
+   }
+
+   m_visibleChunksFrustum = frustum;
+   m_visibleChunksFound = true;
+
+   if (m_chunkIsVisible.empty())
+   {
+      m_chunkIsVisible.assign(WorldTiles::MAP_CHUNKS * WorldTiles::MAP_CHUNKS, false);
+   }
+
+   for (auto& chunk : m_visibleChunks)
+   {
+      m_chunkIsVisible[int(chunk.second) * WorldTiles::MAP_CHUNKS + int(chunk.first)] = false;
+   }
+   m_visibleChunks.clear();
+
+   //  The terrain is flat, so only the ground footprint matters.
+   Rectangle bounds = frustum.GetFootprintBounds(0, 0);
+   int firstChunkx = std::max(int(floorf(bounds.x / 16)), 0);
+   int firstChunkz = std::max(int(floorf(bounds.y / 16)), 0);
+   int lastChunkx = std::min(int(floorf((bounds.x + bounds.width) / 16)), WorldTiles::MAP_CHUNKS - 1);
+   int lastChunkz = std::min(int(floorf((bounds.y + bounds.height) / 16)), WorldTiles::MAP_CHUNKS - 1);
+
+   for (int j = firstChunkz; j <= lastChunkz; ++j)
+   {
+      for (int i = firstChunkx; i <= lastChunkx; ++i)
+      {
+         BoundingBox chunk{ { i * 16.0f, 0, j * 16.0f }, { i * 16.0f + 16, 0, j * 16.0f + 16 } };
+         if (frustum.IsBoxVisible(chunk))
+         {
+            m_visibleChunks.push_back(std::make_pair(float(i), float(j)));
+            m_chunkIsVisible[j * WorldTiles::MAP_CHUNKS + i] = true;
+         }
+      }
+   }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 //#include "Unit.h"
 #include "Geist/Globals.h"
 #include "Geist/Primitives.h"
+#include "CameraFrustum.h"
 #include <string>
 
 class Terrain : public Object
@@ -14,9 +15,38 @@ public:
    int m_width;
    int m_height;
 
+   //  The chunks on screen, as (x, z) chunk numbers, for the camera they were
+   //  last found for.
    std::vector<std::pair <float, float> > m_visibleChunks;
 
-   std::array<std::unique_ptr<Model>, 3072> m_chunkModels;
+   //  Every chunk type's 128x128 image is a layer in a texture array.  One
+   //  array is normally enough, but GL only promises 256 layers, so there can
+   //  be more.
+   std::vector<unsigned int> m_chunkArrays;
+   int m_layersPerArray = 0;
+
+   //  All chunks share one 16x16 quad.  Each frame the visible ones go into the
+   //  instance buffer as (x, z, layer), grouped by array, and each array is
+   //  drawn with one instanced call.
+   unsigned int m_chunkVao = 0;
+   unsigned int m_chunkVertexBuffer = 0;
+   unsigned int m_instanceBuffer = 0;
+   std::vector<std::vector<float> > m_instances;
+
+   Shader m_terrainShader{ 0 };
+   int m_mvpLoc = -1;
+   int m_instanceLoc = -1;
+
+   //  The tile terrain keeps the map itself on the GPU instead: the chunk map,
+   //  every chunk type's tiles, and the 8x8 tile images.  The shader looks up
+   //  each pixel from those, so nothing is baked per chunk type.
+   bool m_tileTerrain = false;
+   unsigned int m_chunkMapTexture = 0;
+   unsigned int m_tileTableTexture = 0;
+   unsigned int m_frameOffsetTexture = 0;
+   unsigned int m_terrainTilesTexture = 0;
+   std::array<unsigned char, 256> m_frameOffsets;
+   bool m_frameOffsetsChanged = false;
 
    Image m_terrainTexture;
    
@@ -26,19 +56,48 @@ public:
    virtual void Init();
    virtual void Init(const std::string& data) {};
 
+   //  Creates the chunk texture arrays.  If chunkPixels is given it holds all
+   //  3072 chunk images back to back (from the asset cache) and they aren't
+   //  composed again.
+   void Init(const unsigned char* chunkPixels);
+
+   //  Sets up the tile terrain instead.  Needs the chunk map, the chunk types
+   //  and the terrain texture, but none of the chunk images.
+   void InitTiles();
+
+   //  Shifts every tile of a terrain shape this many frames along (wrapping at
+   //  32), which is how water and shorelines animate with the tile terrain.
+   void SetTileFrameOffset(int shape, int offset);
+
+   //  Composes the 128x128 RGBA image for one chunk type from the terrain
+   //  texture into dest.  A tile with a bad shape number repeats the last good
+   //  tile, even from the previous chunk, so compose chunks in order.
+   void ComposeChunkImage(unsigned int chunkType, unsigned char* dest, unsigned short& prevShape, unsigned short& prevFrame);
+
 	virtual void Shutdown();
 	virtual void Update();
 	virtual void Draw();
 
    bool IsChunkVisible(int x, int y);
- 
+
+   //  Works out which chunks g_camera can see, if it's moved since last time.
    void FindVisibleChunks();
+   void FindVisibleChunks(const CameraFrustum& frustum);
    int GetNumberOfVisibleChunks() { return m_visibleChunks.size(); }
 
    void UpdateTerrainTexture(Image img);
 
    Image& GetTerrainTexture() { return m_terrainTexture; }
 
+private:
+   //  A square of the given size with its corner at the origin, in m_chunkVao.
+   void CreateQuad(float size);
+   void DrawTiles();
+
+   CameraFrustum m_visibleChunksFrustum;
+   bool m_visibleChunksFound = false;
+   std::vector<bool> m_chunkIsVisible;
+
 };
 
 #endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Geist/ResourceManager.h"
 #include "U7Globals.h"
 #include "TitleState.h"
+#include "SuperchunkStreamer.h"
 
 #include <list>
 #include <string>
@@ -47,26 +48,22 @@ void TitleState::Shutdown()
 
 void TitleState::Update()
 {
+   g_SuperchunkStreamer->Update(g_camera.target);
+
    if (GetTime() - m_LastUpdate > GetFrameTime())
    {
       g_CurrentUpdate++;
 
-      m_sortedVisibleObjects.clear();
-      float drawRange = g_cameraDistance * 1.5f;
-      for (unordered_map<int, shared_ptr<U7Object>>::iterator node = g_ObjectList.begin(); node != g_ObjectList.end(); ++node)
+      CameraFrustum frustum = GetCameraFrustum(g_camera);
+      if (m_visibleObjects.Update(g_camera, frustum, 4.0f))
       {
-         (*node).second->Update();
-         float distance = Vector3Distance((*node).second->m_Pos, g_camera.target);
-         distance -= (*node).second->m_Pos.y;
-         if (distance < drawRange && (*node).second->m_Pos.y <= 4.0f)
-         {
-            double distanceFromCamera = Vector3Distance((*node).second->m_Pos, g_camera.position) - (*node).second->m_Pos.y;
-            (*node).second->m_distanceFromCamera = distanceFromCamera;
-            m_sortedVisibleObjects.push_back((*node).second);
-         }
+         g_chunkTemplates.GetVisibleInstances(g_camera, frustum, m_sortedVisibleTemplates);
       }
 
-      std::sort(m_sortedVisibleObjects.begin(), m_sortedVisibleObjects.end(), [](shared_ptr<U7Object> a, shared_ptr<U7Object> b) { return a->m_distanceFromCamera > b->m_distanceFromCamera; });
+      for (ObjectHandle handle : m_visibleObjects.GetObjects())
+      {
+         g_ObjectList.Get(handle)->Update();
+      }
 
       m_LastUpdate = GetTime();
    }
@@ -116,10 +113,7 @@ void TitleState::Draw()
    g_Terrain->Draw();
 
    //  Draw the objects
-   for (auto& unit : m_sortedVisibleObjects)
-   {
-      unit->Draw();
-   }
+   DrawSortedObjects(m_visibleObjects.GetObjects(), m_sortedVisibleTemplates);
 
    EndMode3D();
 
@@ -257,5 +251,5 @@ void TitleState::TestUpdate()
 
 void TitleState::TestDraw()
 {
-   DrawTexture(g_shapeTable[150][0].m_topTexture->m_Texture, 0, 0, WHITE);
+   DrawShapeTextureEx(g_shapeTable[150][0].m_topTexture->m_Texture, Vector2{ 0, 0 }, 0, 1, WHITE);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "Geist/State.h"
 #include "Geist/Gui.h"
+#include "VisibleObjectSet.h"
 #include <list>
 #include <deque>
 #include <math.h>
@@ -46,7 +47,8 @@ public:
    
    Gui* m_TitleGui = nullptr;
 
-   std::vector<std::shared_ptr<U7Object>> m_sortedVisibleObjects;
+   VisibleObjectSet m_visibleObjects;
+   std::vector<ChunkTemplateInstance> m_sortedVisibleTemplates;
 
    float m_LastUpdate;
 
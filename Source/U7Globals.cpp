@@ -1,4 +1,5 @@
 #include "U7Globals.h"
+#include "SuperchunkStreamer.h"
 #include "Geist/Engine.h"
 #include "Geist/Logging.h"
 #include <algorithm>
@@ -12,7 +13,10 @@ using namespace std;
 
 std::string g_version;
 
-unordered_map<int, std::shared_ptr<U7Object> > g_ObjectList;
+//  Before g_ObjectList, so it's still here while the objects are deleted at exit.
+ChunkObjectMap g_chunkObjectMap; // The objects in each chunk, kept up to date as they move
+
+ObjectStore g_ObjectList;
 
 Mesh* g_AnimationFrames;
 
@@ -30,6 +34,10 @@ std::unique_ptr<RNG> g_NonVitalRNG;
 
 std::unique_ptr<Terrain> g_Terrain;
 
+std::unique_ptr<SuperchunkStreamer> g_SuperchunkStreamer;
+
+std::unique_ptr<ShapeAtlas> g_ShapeAtlas;
+
 std::array<std::array<ShapeData, 32>, 1024> g_shapeTable;
 std::array<ObjectData, 1024> g_objectTable;
 
@@ -39,8 +47,6 @@ unsigned int g_CurrentUpdate;
 
 unsigned int g_minimapSize;
 
-std::vector< std::vector<unsigned short> > g_World;
-
 Vector3 g_Gravity = Vector3{ 0, .1f, 0 };
 
 float g_CameraRotateSpeed = 0;
@@ -56,15 +62,18 @@ std::string g_objectTypeStrings[] = { "Static", "Creature", "Weapon", "Armor", "
 int g_selectedShape = 150;
 int g_selectedFrame = 0;
 
-std::unordered_map<int, int[16][16]> g_ChunkTypeList;  // The 16x16 tiles for each chunk type
-int g_chunkTypeMap[192][192]; // The type of each chunk in the map
-std::vector<U7Object*> g_chunkObjectMap[192][192]; // The objects in each chunk
+WorldTiles g_worldTiles; // The chunk map and the 16x16 tiles of each chunk type
+ChunkTemplates g_chunkTemplates; // The objects in each chunk type, when chunk_templates is set
 
 float g_cameraDistance; // distance from target
 float g_cameraRotation = 0; // angle around target
 
 Shader g_alphaDiscard;
 
+bool g_indexedTextures = false;
+Shader g_paletteShader;
+Texture g_paletteTexture;
+
 bool g_pixelated = false;
 RenderTexture2D g_renderTarget;
 RenderTexture2D g_guiRenderTarget;
@@ -274,32 +283,33 @@ if (IsKeyDown(KEY_E))
 	return 0;
 }
 
-shared_ptr<U7Object> GetObjectFromID(int unitID)
+U7Object* GetObjectFromID(ObjectHandle unitID)
 {
-	unordered_map<int, shared_ptr<U7Object> >::iterator finder = g_ObjectList.find(unitID);
-
-	if (finder == g_ObjectList.end())
-		return nullptr;
-	else
-		return (*finder).second;
+	return g_ObjectList.Get(unitID);
 }
 
-shared_ptr<U7Object> U7ObjectClassFactory(int type)
+U7Object* U7ObjectClassFactory(ObjectHandle id)
 {
-		shared_ptr<U7Object> temp = make_shared<U7Object>();
-		temp->m_ObjectType = type;
+		//  Only the one kind of object so far.
+		U7Object* temp = g_ObjectList.Create(id);
+		if (temp == nullptr)
+		{
+			return nullptr;
+		}
+		temp->m_ID = id;
 		return temp;
 }
 
-vector<shared_ptr<U7Object> > GetAllUnitsWithinRange(float x, float y, float range)
+vector<U7Object*> GetAllUnitsWithinRange(float x, float y, float range)
 {
-	vector<shared_ptr<U7Object> > _Targets;
-	for (auto& unit : g_ObjectList)
+	vector<ObjectHandle> handles;
+	g_chunkObjectMap.GetObjectsInRange(x, y, range, handles);
+
+	vector<U7Object*> _Targets;
+	_Targets.reserve(handles.size());
+	for (ObjectHandle handle : handles)
 	{
-		if (IsDistanceLessThan(x, y, unit.second->m_Pos.x, unit.second->m_Pos.z, range))
-		{
-			_Targets.emplace_back(unit.second);
-		}
+		_Targets.emplace_back(g_ObjectList.Get(handle));
 	}
 
 	return _Targets;
@@ -312,29 +322,99 @@ Vector3 GetRadialVector(float partitions, float thispartition)
 	return Vector3{ cos(finalpartition), 0, sin(finalpartition) };
 }
 
-unsigned int g_CurrentUnitID = 0;
+ObjectHandle GetNextID() { return g_ObjectList.Allocate(); }
+
+CameraFrustum GetCameraFrustum(const Camera& camera)
+{
+	//  Billboards are drawn from their images, which can stick out of their
+	//  bounding boxes a bit.
+	const float margin = 2;
+
+	CameraFrustum frustum;
+	frustum.Set(camera, float(g_Engine->m_RenderWidth) / float(g_Engine->m_RenderHeight), margin);
+	return frustum;
+}
+
+BoundingBox GetShapeBoundingBox(ShapeData* shapeData, ShapeDrawType drawType, Vector3 pos)
+{
+	Vector3 dims = Vector3{ 0, 0, 0 };
+	Vector3 boundingBoxAnchorPoint = Vector3{ 0, 0, 0 };
+
+	ObjectData* objectData = &g_objectTable[shapeData->GetShape()];
 
-unsigned int GetNextID() { return g_CurrentUnitID++; }
+	if (drawType == ShapeDrawType::OBJECT_DRAW_BILLBOARD)
+	{
+		dims = Vector3{ objectData->m_width, objectData->m_height, objectData->m_depth };
+		boundingBoxAnchorPoint = pos;
+	}
+	else if (drawType == ShapeDrawType::OBJECT_DRAW_FLAT)
+	{
+		dims = Vector3{ float(shapeData->m_originalTexture->width) / 8.0f, 0, float(shapeData->m_originalTexture->height) / 8.0f };
+		boundingBoxAnchorPoint = Vector3Add(pos, Vector3{ -dims.x + 1, 0, -dims.z + 1 });
+	}
+	else
+	{
+		dims = Vector3{ objectData->m_width, objectData->m_height, objectData->m_depth };
+		boundingBoxAnchorPoint = Vector3Add(pos, Vector3{ -dims.x + 1, 0, -dims.z + 1 });
+	}
 
-void AddObject(int shapenum, int framenum, int id, float x, float y, float z)
+	return BoundingBox{ boundingBoxAnchorPoint, Vector3Add(boundingBoxAnchorPoint, dims) };
+}
+
+void AddObject(int shapenum, int framenum, ObjectHandle id, float x, float y, float z)
 {
 	if (shapenum == 451)
 	{
 		Log("Stop here.");
 	}
 
-	shared_ptr<U7Object> temp = U7ObjectClassFactory(0);
+	U7Object* temp = U7ObjectClassFactory(id);
+	if (temp == nullptr)
+	{
+		return;
+	}
+
 	temp->Init("Data/Units/Walker.cfg", shapenum, framenum);
 	temp->SetInitialPos(Vector3{ x, y, z });
-	temp->m_ID = id;
+}
 
-	g_ObjectList[id] = temp;
+int DrawSortedObjects(const vector<ObjectHandle>& objects, const vector<ChunkTemplateInstance>& templates)
+{
+	int drawn = 0;
+	auto instance = templates.begin();
+	for (ObjectHandle handle : objects)
+	{
+		U7Object* object = g_ObjectList.Get(handle);
+		if (object == nullptr)
+		{
+			continue;
+		}
+
+		float distance = g_ObjectList.GetRecord(handle)->m_distanceFromCamera;
+		while (instance != templates.end() && instance->m_distanceFromCamera > distance)
+		{
+			instance->Draw();
+			++instance;
+			++drawn;
+		}
+
+		object->Draw();
+		++drawn;
+	}
+
+	for (; instance != templates.end(); ++instance)
+	{
+		instance->Draw();
+		++drawn;
+	}
+
+	return drawn;
 }
 
 void AddObjectToInventory(int objectId, int containerId)
 {
-	shared_ptr<U7Object> object = GetObjectFromID(objectId);
-	shared_ptr<U7Object> container = GetObjectFromID(containerId);
+	U7Object* object = GetObjectFromID(objectId);
+	U7Object* container = GetObjectFromID(containerId);
 
 	if (object == nullptr || container == nullptr)
 	{
@@ -420,10 +500,10 @@ void DrawConsole()
 	}
 }
 
-void AddObjectToContainer(int objectID, int containerID)
+void AddObjectToContainer(ObjectHandle objectID, ObjectHandle containerID)
 {
-	shared_ptr<U7Object> object = GetObjectFromID(objectID);
-	shared_ptr<U7Object> container = GetObjectFromID(containerID);
+	U7Object* object = GetObjectFromID(objectID);
+	U7Object* container = GetObjectFromID(containerID);
 
 	if (object == nullptr || container == nullptr)
 	{
@@ -466,3 +546,41 @@ EngineModes g_engineMode = EngineModes::ENGINE_MODE_BLACK_GATE;
 std::string g_engineModeStrings[] = { "blackgate", "serpentisle", "NONE" };
 
 
+
+void BeginPaletteShaderMode()
+{
+	BeginShaderMode(g_paletteShader);
+
+	//  raylib forgets extra textures after every batch, so this has to be done each time.
+	SetShaderValueTexture(g_paletteShader, g_paletteShader.locs[SHADER_LOC_MAP_SPECULAR], g_paletteTexture);
+}
+
+void UsePaletteShader(Material& material)
+{
+	//  The palette goes in texture1, which raylib binds to the specular map's slot.
+	material.shader = g_paletteShader;
+	material.maps[MATERIAL_MAP_SPECULAR].texture = g_paletteTexture;
+}
+
+void SetActivePalette(int palette)
+{
+	if (palette < 0 || palette >= g_paletteTexture.height)
+	{
+		return;
+	}
+
+	SetShaderValue(g_paletteShader, GetShaderLocation(g_paletteShader, "paletteIndex"), &palette, SHADER_UNIFORM_INT);
+}
+
+void DrawShapeTextureEx(Texture texture, Vector2 position, float rotation, float scale, Color tint)
+{
+	if (!g_indexedTextures)
+	{
+		DrawTextureEx(texture, position, rotation, scale, tint);
+		return;
+	}
+
+	BeginPaletteShaderMode();
+	DrawTextureEx(texture, position, rotation, scale, tint);
+	EndShaderMode();
+}
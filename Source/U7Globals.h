@@ -19,6 +19,11 @@
 #include "Geist/RNG.h"
 #include "Terrain.h"
 #include "ShapeData.h"
+#include "WorldTiles.h"
+#include "ChunkTemplates.h"
+#include "ChunkObjectMap.h"
+#include "CameraFrustum.h"
+#include "ObjectStore.h"
 #include "U7Object.h"
 #include "raylib.h"
 #include "raymath.h"
@@ -115,23 +120,27 @@ extern std::unique_ptr<RNG> g_NonVitalRNG;
 
 extern std::unique_ptr<Terrain> g_Terrain;
 
-extern std::unordered_map<int, std::shared_ptr<U7Object> > g_ObjectList;
+class SuperchunkStreamer;
+extern std::unique_ptr<SuperchunkStreamer> g_SuperchunkStreamer;
+
+//  Every object shape frame packed into a few textures; see ShapeAtlas.h.
+extern std::unique_ptr<ShapeAtlas> g_ShapeAtlas;
+
+extern ObjectStore g_ObjectList;
 
 extern unsigned int g_CurrentUpdate;
 
 extern bool g_CameraMoved;
 
-extern std::unordered_map<int, int[16][16] > g_ChunkTypeList;  // The 16x16 tiles for each chunk type
-extern int g_chunkTypeMap[192][192]; // The type of each chunk in the map
-extern std::vector<U7Object*> g_chunkObjectMap[192][192]; // The objects in each chunk
+extern WorldTiles g_worldTiles; // The chunk map and the 16x16 tiles of each chunk type
+extern ChunkTemplates g_chunkTemplates; // The objects in each chunk type, when chunk_templates is set
+extern ChunkObjectMap g_chunkObjectMap; // The objects in each chunk, kept up to date as they move
 
 extern std::array<std::array<ShapeData, 32>, 1024> g_shapeTable;
 extern std::array<ObjectData, 1024> g_objectTable;
 
 extern unsigned int g_minimapSize;
 
-extern std::vector< std::vector<unsigned short> > g_World;
-
 float GetDistance(float startX, float startZ, float endX, float endZ);
 
 bool IsDistanceLessThan(float startX, float startZ, float endX, float endZ, float range);
@@ -144,21 +153,35 @@ void IsCellVisible(float x, float y);
 
 void IsPointVisible(float x, float y);
 
-std::shared_ptr<U7Object> GetObjectFromID(int unitID);
+//  nullptr if there's no such object, or it's been deleted.
+U7Object* GetObjectFromID(ObjectHandle unitID);
 
-std::shared_ptr<U7Object> U7ObjectClassFactory(int type);
+//  Makes the object for a handle from GetNextID(), in g_ObjectList.
+U7Object* U7ObjectClassFactory(ObjectHandle id);
 
 void PopulateLocationMap();
 
-std::vector<std::shared_ptr<U7Object> > GetAllUnitsWithinRange(float x, float y, float range);
+std::vector<U7Object*> GetAllUnitsWithinRange(float x, float y, float range);
 
 Vector3 GetRadialVector(float partitions, float thispartition);
 
-void AddObject(int shapenum, int framenum, int id, float x, float y, float z);
+//  The box a shape takes up when it's drawn at pos, for picking.
+BoundingBox GetShapeBoundingBox(ShapeData* shapeData, ShapeDrawType drawType, Vector3 pos);
+
+void AddObject(int shapenum, int framenum, ObjectHandle id, float x, float y, float z);
+
+void AddObjectToContainer(ObjectHandle objectID, ObjectHandle containerID);
+
+//  Draws two lists sorted farthest first as if they were one, skipping objects
+//  that have been deleted since.  Returns how many were drawn.
+int DrawSortedObjects(const std::vector<ObjectHandle>& objects, const std::vector<ChunkTemplateInstance>& templates);
 
-void AddObjectToContainer(int objectID, int containerID);
+//  What g_camera (or another camera set up the same way) shows at the render
+//  resolution, widened a little for sprites that hang over their boxes.
+CameraFrustum GetCameraFrustum(const Camera& camera);
 
-unsigned int GetNextID();
+//  Sets aside a slot in g_ObjectList for an object AddObject() will create.
+ObjectHandle GetNextID();
 
 //////////////////////////////////////////////////////////////////////////////
 //  CONSOLE
@@ -231,6 +254,26 @@ extern int g_selectedFrame;
 
 extern Shader g_alphaDiscard;
 
+//  indexed_textures in engine.cfg.  When it's set, shape frames are kept as
+//  8-bit palette indices on the CPU and the GPU, and drawn through
+//  g_paletteShader, which looks their colors up in g_paletteTexture: one row
+//  per palette in PALETTES.FLX.
+extern bool g_indexedTextures;
+extern Shader g_paletteShader;
+extern Texture g_paletteTexture;
+
+//  Like BeginShaderMode(g_paletteShader), but also binds the palettes.  End it with EndShaderMode().
+void BeginPaletteShaderMode();
+
+//  Makes a model's material draw its (indexed) diffuse texture through the palette.
+void UsePaletteShader(Material& material);
+
+//  Switches every indexed texture to another palette from PALETTES.FLX, without re-uploading anything.
+void SetActivePalette(int palette);
+
+//  DrawTextureEx for shape textures, which need the palette shader when they're indexed.
+void DrawShapeTextureEx(Texture texture, Vector2 position, float rotation, float scale, Color tint);
+
 extern bool g_pixelated;
 extern RenderTexture2D g_renderTarget;
 extern RenderTexture2D g_guiRenderTarget;
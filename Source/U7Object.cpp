@@ -16,45 +16,38 @@ U7Object::~U7Object()
 
 void U7Object::Init(const string& configfile, int unitType, int frame)
 {
-   m_Pos = Vector3{ 0, 0, 0 };
-   m_Dest = Vector3{ 0, 0, 0 };
-   m_Direction = Vector3{ 0, 0, 0 };
-   m_Scaling = Vector3{ 1, 1, 1 };
-   m_ExternalForce = Vector3{ 0, 0, 0 };
-   m_GravityFlag = true;
-   m_ExternalForceFlag = true;
    m_Angle = 0;
    m_Selected = false;
-   m_Visible = true;
-   m_Mesh = NULL;
-   m_ObjectType = unitType;
    SetIsDead(false);
    m_UnitConfig = g_ResourceManager->GetConfig(configfile);
-   m_Frame = frame;
-   m_shapeData = &g_shapeTable[m_ObjectType][m_Frame];
-   m_drawType = m_shapeData->GetDrawType();
-   m_isContainer = false;
-   m_isContained = false;
-   m_isEgg = false;
+   m_shapeData = &g_shapeTable[unitType][frame];
    m_hasGump = false;
-   m_inventory.clear();
+   m_cold = nullptr;
+
+   ObjectRecord* record = GetRecord();
+   g_chunkObjectMap.Remove(ObjectHandle(m_ID), *record);
+   *record = ObjectRecord();
+   record->m_shape = uint16_t(unitType);
+   record->m_frame = uint8_t(frame);
 }
 
 void U7Object::Draw()
 {
+   ObjectRecord* record = GetRecord();
+
    if (!(g_StateMachine->GetCurrentState() == STATE_OBJECTEDITORSTATE))
    {
-      if (!m_Visible || m_isContained || m_isEgg) 
+      if (!record->IsDrawn())
       {
          return;
       }
 	}
 
-   m_shapeData->Draw(m_Pos, m_Angle, m_color);
+   m_shapeData->Draw(record->m_pos, m_Angle, m_color);
 
    if (g_Engine->m_debugDrawing)
    {
-		DrawBoundingBox(m_boundingBox, MAGENTA);
+		DrawBoundingBox(record->m_boundingBox, MAGENTA);
 	}
 }
 
@@ -70,60 +63,62 @@ void U7Object::Attack(int _UnitID)
 
 void U7Object::Shutdown()
 {
-
+   ObjectRecord* record = GetRecord();
+   if (record != nullptr)
+   {
+      g_chunkObjectMap.Remove(ObjectHandle(m_ID), *record);
+   }
 }
 
 void U7Object::SetPos(Vector3 pos)
 {
-   m_Pos = pos;
+   ObjectRecord* record = GetRecord();
+   Vector3 oldPos = record->m_pos;
+   record->m_pos = pos;
+   record->m_boundingBox = GetShapeBoundingBox(m_shapeData, m_shapeData->GetDrawType(), pos);
+   g_chunkObjectMap.Update(ObjectHandle(m_ID), *record, oldPos);
+}
 
-   Vector3 dims = Vector3{ 0, 0, 0 };
-   Vector3 boundingBoxAnchorPoint = Vector3{ 0, 0, 0 };
+Vector3 U7Object::GetPos()
+{
+   return GetRecord()->m_pos;
+}
 
-   ObjectData* objectData = &g_objectTable[m_shapeData->GetShape()];
+ObjectRecord* U7Object::GetRecord() const
+{
+   return g_ObjectList.GetRecord(ObjectHandle(m_ID));
+}
 
-   if (m_drawType == ShapeDrawType::OBJECT_DRAW_BILLBOARD)
-   {
-      dims = Vector3{ objectData->m_width, objectData->m_height, objectData->m_depth };
-      boundingBoxAnchorPoint = Vector3Add(m_Pos, Vector3{ 0, 0, 0 });
-   }
-   else if (m_drawType == ShapeDrawType::OBJECT_DRAW_FLAT)
-   {
-      dims = Vector3{ float(m_shapeData->m_originalTexture->width) / 8.0f, 0, float(m_shapeData->m_originalTexture->height) / 8.0f };
-      boundingBoxAnchorPoint = Vector3Add(m_Pos, Vector3{ -dims.x + 1, 0, -dims.z + 1 });
-   }
-   else
+U7ObjectColdData& U7Object::GetColdData()
+{
+   if (m_cold == nullptr)
    {
-      dims = Vector3{ objectData->m_width, objectData->m_height, objectData->m_depth };
-      boundingBoxAnchorPoint = Vector3Add(m_Pos, Vector3{ -dims.x + 1, 0, -dims.z + 1 });
+      m_cold = make_unique<U7ObjectColdData>();
+      m_cold->m_Dest = GetPos();
    }
-
-   m_boundingBox = { boundingBoxAnchorPoint, Vector3Add(boundingBoxAnchorPoint, dims) };
+   return *m_cold;
 }
 
-bool U7Object::Pick()
+const vector<ObjectHandle>& U7Object::GetInventory() const
 {
-   bool picked = false;
-
-   Ray ray = GetMouseRay(GetMousePosition(), g_camera);
-
-   RayCollision collision = GetRayCollisionBox(ray, m_boundingBox);
-
-   return collision.hit;
+   static const vector<ObjectHandle> empty;
+   return m_cold ? m_cold->m_inventory : empty;
 }
 
 void U7Object::SetDest(Vector3 dest)
 {
-   m_Dest = dest;
-   m_Direction = Vector3Subtract(m_Dest, m_Pos);
-   m_Direction = Vector3Normalize(m_Direction);
+   U7ObjectColdData& cold = GetColdData();
+   cold.m_Dest = dest;
+   cold.m_Direction = Vector3Subtract(cold.m_Dest, GetPos());
+   cold.m_Direction = Vector3Normalize(cold.m_Direction);
 }
 
 bool U7Object::AddObjectToInventory(int objectid)
 {
-   if (m_isContainer)
+   if (GetIsContainer())
    {
-      m_inventory.push_back(objectid);
+      GetColdData().m_inventory.push_back(objectid);
+      return true;
    }
    else
    {
@@ -133,20 +128,19 @@ bool U7Object::AddObjectToInventory(int objectid)
 
 bool U7Object::RemoveObjectFromInventory(int objectid)
 {
-   if (m_isContainer)
+   if (GetIsContainer() && m_cold)
 	{
-		for (int i = 0; i < m_inventory.size(); i++)
+		vector<ObjectHandle>& inventory = m_cold->m_inventory;
+		for (int i = 0; i < inventory.size(); i++)
 		{
-			if (m_inventory[i] == objectid)
+			if (inventory[i] == objectid)
 			{
-            GetObjectFromID(objectid)->m_isContained = true;
-				m_inventory.erase(m_inventory.begin() + i);
+            GetObjectFromID(objectid)->SetIsContained(true);
+				inventory.erase(inventory.begin() + i);
 				return true;
 			}
 		}
 	}
-	else
-	{
-		return false;
-	}
-}
\ No newline at end of file
+
+	return false;
+}
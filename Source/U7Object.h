@@ -3,13 +3,56 @@
 
 #include "Geist/Globals.h"
 #include "Geist/BaseUnits.h"
+#include "ObjectStore.h"
 #include <string>
 #include <list>
+#include <memory>
+#include <vector>
 
 enum class ObjectTypes;
 enum class ShapeDrawType;
 class ShapeData;
 
+//  Everything only a few objects use: creatures, things that move, containers.
+//  An object doesn't have any of this until something asks for it.
+struct U7ObjectColdData
+{
+   Vector3 m_Dest{ 0, 0, 0 };
+   Vector3 m_Direction{ 0, 0, 0 };
+   Vector3 m_Scaling{ 1, 1, 1 };
+
+   Vector3 m_ExternalForce{ 0, 0, 0 };
+
+   float m_BaseSpeed = 0;
+   float m_BaseMaxHP = 0;
+   float m_BaseHP = 0;
+   float m_BaseAttack = 0;
+   float m_BaseDefense = 0;
+   float m_BaseTeam = 0;
+
+   float m_speed = 0;
+   float m_hp = 0;
+   float m_combat = 0;
+   float m_magic = 0;
+   int m_Team = 0;
+
+   bool m_GravityFlag = true;
+   bool m_ExternalForceFlag = true;
+   bool m_BounceFlag = false;
+
+   Mesh* m_Mesh = nullptr;
+   Texture* m_Texture = nullptr;
+   Texture* m_DropShadow = nullptr;
+   std::unique_ptr<Mesh> m_customMesh = nullptr;
+
+   Config* m_ObjectConfig = nullptr;
+
+   std::vector<ObjectHandle> m_inventory; //  Each entry is the ID of an object in the object list
+};
+
+//  The position, bounds, shape and flags live in the object's ObjectRecord in
+//  g_ObjectList, so the loops over every object don't have to touch this.
+//  Objects only exist in g_ObjectList.
 class U7Object : public Unit3D
 {
 
@@ -25,76 +68,48 @@ public:
 
    virtual void Attack(int unitid);
 
-   virtual Vector3 GetPos() { return m_Pos; }
-   virtual Vector3 GetDest() { return m_Dest; }
-   virtual float GetSpeed() { return m_speed; }
+   virtual Vector3 GetPos();
+   virtual Vector3 GetDest() { return m_cold ? m_cold->m_Dest : GetPos(); }
+   virtual float GetSpeed() { return m_cold ? m_cold->m_speed : 0; }
 
-   void SetInitialPos(Vector3 pos) { SetPos(pos); SetDest(pos); }
+   void SetInitialPos(Vector3 pos) { SetPos(pos); if (m_cold) SetDest(pos); }
    virtual void SetPos(Vector3 pos);
    virtual void SetDest(Vector3 pos);
-   virtual void SetSpeed(float speed) { m_speed = speed; }
-
-   bool Pick();
+   virtual void SetSpeed(float speed) { GetColdData().m_speed = speed; }
 
    bool AddObjectToInventory(int objectid);
    bool RemoveObjectFromInventory(int objectid);
 
-   Vector3 m_Pos;
-   Vector3 m_Dest;
-   Vector3 m_Direction;
-   Vector3 m_Scaling;
-
-   Vector3 m_ExternalForce;
+   ObjectRecord* GetRecord() const;
 
-   float m_Angle;
+   bool GetIsVisible() const { return GetRecord()->GetFlag(ObjectRecord::VISIBLE); }
+   void SetIsVisible(bool visible) { GetRecord()->SetFlag(ObjectRecord::VISIBLE, visible); }
+   bool GetIsContainer() const { return GetRecord()->GetFlag(ObjectRecord::CONTAINER); }
+   void SetIsContainer(bool container) { GetRecord()->SetFlag(ObjectRecord::CONTAINER, container); }
+   bool GetIsContained() const { return GetRecord()->GetFlag(ObjectRecord::CONTAINED); }
+   void SetIsContained(bool contained) { GetRecord()->SetFlag(ObjectRecord::CONTAINED, contained); }
+   bool GetIsEgg() const { return GetRecord()->GetFlag(ObjectRecord::EGG); }
+   void SetIsEgg(bool egg) { GetRecord()->SetFlag(ObjectRecord::EGG, egg); }
 
-   int m_ObjectType;
-   int m_Frame;
+   //  Makes the cold data if the object doesn't have any yet.
+   U7ObjectColdData& GetColdData();
+   bool HasColdData() const { return m_cold != nullptr; }
 
-   bool m_Visible;
-   bool m_Selected;
+   //  Empty unless the object is a container that's had something put in it.
+   const std::vector<ObjectHandle>& GetInventory() const;
 
-   float m_BaseSpeed;
-   float m_BaseMaxHP;
-   float m_BaseHP;
-   float m_BaseAttack;
-   float m_BaseDefense;
-   float m_BaseTeam;
-
-   float m_speed;
-   float m_hp;
-   float m_combat;
-   float m_magic;
-   int m_Team;
-
-   bool m_GravityFlag;
-   bool m_ExternalForceFlag;
-   bool m_BounceFlag;
-
-   Mesh* m_Mesh;
-   Texture* m_Texture;
-   Texture* m_DropShadow;
-   std::unique_ptr<Mesh> m_customMesh = nullptr;
+   float m_Angle;
 
-   Config* m_ObjectConfig;
+   bool m_Selected;
 
-   ShapeDrawType m_drawType;
    ShapeData* m_shapeData;
 
-   double m_distanceFromCamera;
-
    Color m_color = WHITE;
 
-   BoundingBox m_boundingBox;
-
-   bool m_isContainer;
-   bool m_isContained;
    bool m_hasConversationTree;
    bool m_hasGump;
-   bool m_isEgg;
-
-   std::vector<int> m_inventory; //  Each entry is the ID of an object in the object list
 
+   std::unique_ptr<U7ObjectColdData> m_cold = nullptr;
 };
 
-#endif
\ No newline at end of file
+#endif
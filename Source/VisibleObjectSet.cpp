@@ -0,0 +1,248 @@
+#include "VisibleObjectSet.h"
+#include "U7Globals.h"
+#include <algorithm>
+
+using namespace std;
+
+VisibleObjectSet::ChunkRect VisibleObjectSet::GetChunkRect(const CameraFrustum& frustum) const
+{
+	//  Everywhere the view passes through, up to the top of the tallest box,
+	//  and out as far as any box reaches from its own chunk.
+	Rectangle bounds = frustum.GetFootprintBounds(0, g_chunkObjectMap.GetMaxTop());
+	int margin = g_chunkObjectMap.GetChunkMargin();
+
+	ChunkRect rect;
+	rect.m_left = max(ChunkObjectMap::ChunkOf(bounds.x) - margin, 0);
+	rect.m_top = max(ChunkObjectMap::ChunkOf(bounds.y) - margin, 0);
+	rect.m_right = min(ChunkObjectMap::ChunkOf(bounds.x + bounds.width) + margin, ChunkObjectMap::MAP_CHUNKS - 1);
+	rect.m_bottom = min(ChunkObjectMap::ChunkOf(bounds.y + bounds.height) + margin, ChunkObjectMap::MAP_CHUNKS - 1);
+	return rect;
+}
+
+bool VisibleObjectSet::IsChunkInView(int chunkx, int chunkz, const CameraFrustum& frustum) const
+{
+	//  The edge chunks also hold anything off the edge of the map.
+	if (chunkx <= 0 || chunkz <= 0 || chunkx >= ChunkObjectMap::MAP_CHUNKS - 1 || chunkz >= ChunkObjectMap::MAP_CHUNKS - 1)
+	{
+		return true;
+	}
+
+	float reach = float(g_chunkObjectMap.GetChunkMargin() * ChunkObjectMap::CHUNK_SIZE);
+	float left = float(chunkx * ChunkObjectMap::CHUNK_SIZE);
+	float top = float(chunkz * ChunkObjectMap::CHUNK_SIZE);
+	BoundingBox column{ { left - reach, 0, top - reach },
+		{ left + ChunkObjectMap::CHUNK_SIZE + reach, g_chunkObjectMap.GetMaxTop(), top + ChunkObjectMap::CHUNK_SIZE + reach } };
+	return frustum.IsBoxVisible(column);
+}
+
+bool VisibleObjectSet::IsChunkInside(int chunkx, int chunkz, const CameraFrustum& frustum) const
+{
+	//  The edge chunks also hold anything off the edge of the map.
+	if (chunkx <= 0 || chunkz <= 0 || chunkx >= ChunkObjectMap::MAP_CHUNKS - 1 || chunkz >= ChunkObjectMap::MAP_CHUNKS - 1)
+	{
+		return false;
+	}
+
+	//  Every box has a bottom corner at most a tile past its object's position
+	//  (see GetShapeBoundingBox()), and objects are never below the ground, so
+	//  if this is all in view, some of every object's box under the cutoff is.
+	float left = float(chunkx * ChunkObjectMap::CHUNK_SIZE);
+	float top = float(chunkz * ChunkObjectMap::CHUNK_SIZE);
+	BoundingBox column{ { left, 0, top }, { left + ChunkObjectMap::CHUNK_SIZE + 1, max(m_heightCutoff, 0.0f), top + ChunkObjectMap::CHUNK_SIZE + 1 } };
+	return frustum.IsBoxInside(column);
+}
+
+bool VisibleObjectSet::Accepts(ObjectRecord& record, const Camera& camera) const
+{
+	if (record.m_pos.y <= m_heightCutoff && m_frustum.IsBoxVisible(record.m_boundingBox))
+	{
+		record.m_distanceFromCamera = Vector3Distance(record.m_pos, camera.position) - record.m_pos.y;
+		return true;
+	}
+	return false;
+}
+
+bool VisibleObjectSet::IsInList(ObjectHandle handle) const
+{
+	uint32_t index = handle & ObjectStore::INDEX_MASK;
+	return index < m_inList.size() && m_inList[index] == handle;
+}
+
+void VisibleObjectSet::SetInList(ObjectHandle handle, bool inList)
+{
+	uint32_t index = handle & ObjectStore::INDEX_MASK;
+	if (index >= m_inList.size())
+	{
+		m_inList.resize(index + 1, ObjectHandle(ObjectStore::INVALID_HANDLE));
+	}
+	if (inList)
+	{
+		m_inList[index] = handle;
+	}
+	else if (m_inList[index] == handle)
+	{
+		m_inList[index] = ObjectStore::INVALID_HANDLE;
+	}
+}
+
+void VisibleObjectSet::Sort()
+{
+	//  The list is still in last update's order, which is what lets the sorter
+	//  get away with an insertion sort most of the time.
+	m_sortEntries.resize(m_objects.size());
+	for (size_t i = 0; i < m_objects.size(); ++i)
+	{
+		m_sortEntries[i] = { DepthSortKey(g_ObjectList.GetRecord(m_objects[i])->m_distanceFromCamera), m_objects[i] };
+	}
+
+	m_sorter.Sort(m_sortEntries);
+
+	for (size_t i = 0; i < m_objects.size(); ++i)
+	{
+		m_objects[i] = m_sortEntries[i].m_handle;
+	}
+}
+
+void VisibleObjectSet::Build(const Camera& camera, const CameraFrustum& frustum, float heightCutoff)
+{
+	for (ObjectHandle handle : m_objects)
+	{
+		SetInList(handle, false);
+	}
+
+	m_removed = m_objects.size();
+	m_objects.clear();
+	m_considered = 0;
+
+	m_frustum = frustum;
+	m_heightCutoff = heightCutoff;
+	m_chunkRect = GetChunkRect(frustum);
+	m_mapVersion = g_chunkObjectMap.GetVersion();
+	m_built = true;
+
+	for (int chunkz = m_chunkRect.m_top; chunkz <= m_chunkRect.m_bottom; ++chunkz)
+	{
+		for (int chunkx = m_chunkRect.m_left; chunkx <= m_chunkRect.m_right; ++chunkx)
+		{
+			if (!IsChunkInView(chunkx, chunkz, frustum))
+			{
+				continue;
+			}
+
+			for (ObjectHandle handle : g_chunkObjectMap.GetChunk(chunkx, chunkz))
+			{
+				++m_considered;
+				if (Accepts(*g_ObjectList.GetRecord(handle), camera))
+				{
+					m_objects.push_back(handle);
+					SetInList(handle, true);
+				}
+			}
+		}
+	}
+
+	m_added = m_objects.size();
+	Sort();
+}
+
+bool VisibleObjectSet::Update(const Camera& camera, const CameraFrustum& frustum, float heightCutoff)
+{
+	if (!m_built || heightCutoff != m_heightCutoff)
+	{
+		Build(camera, frustum, heightCutoff);
+		return true;
+	}
+
+	bool cameraMoved = frustum != m_frustum;
+	bool worldChanged = g_chunkObjectMap.GetVersion() != m_mapVersion;
+
+	m_considered = 0;
+	m_added = 0;
+	m_removed = 0;
+
+	if (!cameraMoved && !worldChanged)
+	{
+		return false;
+	}
+
+	CameraFrustum oldFrustum = m_frustum;
+	m_frustum = frustum;
+
+	//  Everything already in the list: still visible, and how far away now?
+	size_t kept = 0;
+	for (ObjectHandle handle : m_objects)
+	{
+		++m_considered;
+		ObjectRecord* record = g_ObjectList.GetRecord(handle);
+		if (record != nullptr && record->GetFlag(ObjectRecord::IN_CHUNK_MAP) && Accepts(*record, camera))
+		{
+			m_objects[kept++] = handle;
+		}
+		else
+		{
+			SetInList(handle, false);
+			++m_removed;
+		}
+	}
+	m_objects.resize(kept);
+
+	//  Then anything new, from the chunks that could have some.  A chunk that was
+	//  wholly in view before and still is already has everything in it that can
+	//  be seen in the list, unless something in it changed.
+	ChunkRect chunkRect = GetChunkRect(frustum);
+	for (int chunkz = chunkRect.m_top; chunkz <= chunkRect.m_bottom; ++chunkz)
+	{
+		for (int chunkx = chunkRect.m_left; chunkx <= chunkRect.m_right; ++chunkx)
+		{
+			if (m_chunkRect.Contains(chunkx, chunkz) && !g_chunkObjectMap.ChunkChangedSince(chunkx, chunkz, m_mapVersion)
+				&& (!cameraMoved || (IsChunkInside(chunkx, chunkz, oldFrustum) && IsChunkInside(chunkx, chunkz, frustum))))
+			{
+				continue;
+			}
+
+			if (!IsChunkInView(chunkx, chunkz, frustum))
+			{
+				continue;
+			}
+
+			for (ObjectHandle handle : g_chunkObjectMap.GetChunk(chunkx, chunkz))
+			{
+				if (IsInList(handle))
+				{
+					continue;
+				}
+
+				++m_considered;
+				if (Accepts(*g_ObjectList.GetRecord(handle), camera))
+				{
+					m_objects.push_back(handle);
+					SetInList(handle, true);
+					++m_added;
+				}
+			}
+		}
+	}
+
+	m_chunkRect = chunkRect;
+	m_mapVersion = g_chunkObjectMap.GetVersion();
+
+	Sort();
+	return true;
+}
+
+void VisibleObjectSet::Insert(ObjectHandle handle)
+{
+	const ObjectRecord* record = g_ObjectList.GetRecord(handle);
+	if (record == nullptr || IsInList(handle))
+	{
+		return;
+	}
+
+	auto place = find_if(m_objects.begin(), m_objects.end(), [record](ObjectHandle other)
+		{
+			const ObjectRecord* otherRecord = g_ObjectList.GetRecord(other);
+			return otherRecord != nullptr && otherRecord->m_distanceFromCamera < record->m_distanceFromCamera;
+		});
+	m_objects.insert(place, handle);
+	SetInList(handle, true);
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     VISIBLEOBJECTSET.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  The objects the camera can see, farthest first.  Only the
+//           chunks under the camera's view are looked at, using
+//           g_chunkObjectMap, so building the list costs what's on screen
+//           rather than what's in the world.
+//
+//           The list is kept from one update to the next rather than made
+//           again.  Nothing is done while the camera and the objects sit
+//           still.  When the camera moves, the objects already in the list
+//           are checked again, and only the chunks that came into view,
+//           the ones the edge of the screen passes through, and the ones
+//           something changed in are searched for new objects.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _VISIBLEOBJECTSET_H_
+#define _VISIBLEOBJECTSET_H_
+
+#include "raylib.h"
+#include "ObjectStore.h"
+#include "DepthSort.h"
+#include "CameraFrustum.h"
+#include <cstdint>
+#include <vector>
+
+class VisibleObjectSet
+{
+public:
+	//  An object is visible if any of its bounding box is in the frustum, and
+	//  it's no higher than heightCutoff.  Each visible object's
+	//  m_distanceFromCamera is set from the camera, and the list is sorted on
+	//  it.  Returns false if nothing had changed, so the list was left alone.
+	bool Update(const Camera& camera, const CameraFrustum& frustum, float heightCutoff);
+
+	//  Throws the list away and makes it again from every chunk in view.
+	void Build(const Camera& camera, const CameraFrustum& frustum, float heightCutoff);
+
+	//  Puts an object made since the last update into the list, in its place
+	//  by its m_distanceFromCamera.
+	void Insert(ObjectHandle handle);
+
+	const std::vector<ObjectHandle>& GetObjects() const { return m_objects; }
+
+	//  From the last update: how many objects were looked at, how many made it
+	//  into the list, and how many went in and came out of it.
+	size_t GetConsidered() const { return m_considered; }
+	size_t GetAccepted() const { return m_objects.size(); }
+	size_t GetAdded() const { return m_added; }
+	size_t GetRemoved() const { return m_removed; }
+	bool GetSortUsedRadix() const { return m_sorter.GetUsedRadix(); }
+
+private:
+	struct ChunkRect
+	{
+		int m_left = 0;
+		int m_top = 0;
+		int m_right = -1;
+		int m_bottom = -1;
+
+		bool Contains(int chunkx, int chunkz) const { return chunkx >= m_left && chunkx <= m_right && chunkz >= m_top && chunkz <= m_bottom; }
+	};
+
+	ChunkRect GetChunkRect(const CameraFrustum& frustum) const;
+
+	//  Whether any object in a chunk could have some of its box in view.
+	bool IsChunkInView(int chunkx, int chunkz, const CameraFrustum& frustum) const;
+
+	//  Whether all of a chunk is so far inside the view that everything in it
+	//  under the height cutoff is visible.
+	bool IsChunkInside(int chunkx, int chunkz, const CameraFrustum& frustum) const;
+
+	bool Accepts(ObjectRecord& record, const Camera& camera) const;
+
+	bool IsInList(ObjectHandle handle) const;
+	void SetInList(ObjectHandle handle, bool inList);
+
+	void Sort();
+
+	std::vector<ObjectHandle> m_objects;
+
+	std::vector<DepthSortEntry> m_sortEntries;
+	DepthSorter m_sorter;
+
+	//  By slot: the handle of the object there if it's in the list.
+	std::vector<ObjectHandle> m_inList;
+
+	//  What the list was made for.
+	bool m_built = false;
+	CameraFrustum m_frustum;
+	float m_heightCutoff = 0;
+	ChunkRect m_chunkRect;
+	uint32_t m_mapVersion = 0;
+
+	size_t m_considered = 0;
+	size_t m_added = 0;
+	size_t m_removed = 0;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "WorldTiles.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+WorldTiles::WorldTiles()
+{
+	//  Sized up front so the chunk and map loaders can fill them in at the same time.
+	m_chunkTiles.resize(CHUNK_TYPES * 256, 0);
+	m_chunkMap.resize(MAP_CHUNKS * MAP_CHUNKS, 0);
+}
+
+void WorldTiles::GetRow(int x, int z, int count, uint16_t* out) const
+{
+	if (z < 0 || z >= WORLD_TILES)
+	{
+		memset(out, 0, count * sizeof(uint16_t));
+		return;
+	}
+
+	int end = x + count;
+	while (x < end)
+	{
+		if (x < 0 || x >= WORLD_TILES)
+		{
+			*out++ = 0;
+			++x;
+			continue;
+		}
+
+		//  The rest of this row of the chunk is contiguous.
+		int run = std::min(16 - (x & 15), end - x);
+		const uint16_t* tiles = GetChunkTiles(GetChunkType(x >> 4, z >> 4)) + (z & 15) * 16 + (x & 15);
+		memcpy(out, tiles, run * sizeof(uint16_t));
+		out += run;
+		x += run;
+	}
+}
+
+void WorldTiles::GetRect(int x, int z, int width, int height, uint16_t* out) const
+{
+	for (int row = 0; row < height; ++row)
+	{
+		GetRow(x, z + row, width, out + row * width);
+	}
+}
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Name:     WORLDTILES.H
+// Author:   Anthony Salter
+// Date:     10/17/26
+// Purpose:  The terrain tiles of the whole 3072x3072 world, kept the way
+//           Ultima VII keeps them: a 192x192 map of chunk types, and the
+//           16x16 tiles of each of the 3072 chunk types.  Both are flat
+//           arrays of 16-bit values, so looking a tile up is two reads
+//           and the whole thing is about 1.5 MB.
+//
+//           A tile is a shape number in the low 10 bits and a frame in
+//           the next 5, same as in U7CHUNKS.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _WORLDTILES_H_
+#define _WORLDTILES_H_
+
+#include <cstdint>
+#include <vector>
+
+class WorldTiles
+{
+public:
+	static const int CHUNK_TYPES = 3072;
+	static const int MAP_CHUNKS = 192;
+	static const int WORLD_TILES = MAP_CHUNKS * 16;
+
+	WorldTiles();
+
+	void SetChunkTile(int chunkType, int x, int z, uint16_t tile) { m_chunkTiles[chunkType * 256 + z * 16 + x] = tile; }
+	void SetChunkType(int chunkx, int chunkz, uint16_t chunkType) { m_chunkMap[chunkz * MAP_CHUNKS + chunkx] = chunkType; }
+
+	uint16_t GetChunkType(int chunkx, int chunkz) const { return m_chunkMap[chunkz * MAP_CHUNKS + chunkx]; }
+
+	//  The 256 tiles of a chunk type, a row of 16 at a time.
+	const uint16_t* GetChunkTiles(int chunkType) const { return &m_chunkTiles[chunkType * 256]; }
+
+	//  x and z are in tiles and have to be inside the world.
+	inline uint16_t TileAt(int x, int z) const
+	{
+		return m_chunkTiles[m_chunkMap[(z >> 4) * MAP_CHUNKS + (x >> 4)] * 256 + (z & 15) * 16 + (x & 15)];
+	}
+
+	static int TileShape(uint16_t tile) { return tile & 0x3ff; }
+	static int TileFrame(uint16_t tile) { return (tile >> 10) & 0x1f; }
+
+	//  Copies count tiles of row z, starting at x, into out.  These go a chunk
+	//  at a time rather than a tile at a time, and anything outside the world
+	//  comes back as 0.
+	void GetRow(int x, int z, int count, uint16_t* out) const;
+
+	//  Copies a width by height block of tiles into out, one row after another.
+	void GetRect(int x, int z, int width, int height, uint16_t* out) const;
+
+private:
+	std::vector<uint16_t> m_chunkTiles;
+	std::vector<uint16_t> m_chunkMap;
+};
+
+#endif